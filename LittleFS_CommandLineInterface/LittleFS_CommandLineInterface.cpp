@@ -21,11 +21,16 @@
 //-----------------------------------------------------
 LittleFS_CommandLineInterface::LittleFS_CommandLineInterface(){
 //-----------------------------------------------------
-  LittleFS.begin();
+  if (LittleFS.begin()){
+    cleanTempFile();
+  }
   cmdHistIdx  = 0;
   pathPattern = "";
   setWorkDir("/");
   exit        = false;      
+  cancel      = false;
+  lastYield   = millis();
+  indexChangeCount = 0;
 }
   
 //-----------------------------------------------------
@@ -72,7 +77,10 @@ bool LittleFS_CommandLineInterface::readCommandLine() {
 
   cmdHistory(commandLine);
   splitLine(commandLine, 0);
+  cancel    = false;
+  lastYield = millis();
   cmdInterpreter();
+  indexFlush();
   
   return true;
 }
@@ -85,6 +93,31 @@ void LittleFS_CommandLineInterface::setWorkDir(String path){
   prompt = "\r"+workDir+" >";
 }
 
+// Long loops call it, so ESP8266 watchdog does not reset
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::yieldOnTime(){
+//-----------------------------------------------------
+  if (millis() - lastYield >= YIELD_TIME){
+    yield();
+    lastYield = millis();
+  }
+}
+
+// Cancellation point of long commands, between file chunks and directory entries.
+// Characters typed while a command runs are read out, CTRL+C is found behind them too.
+//-----------------------------------------------------
+bool LittleFS_CommandLineInterface::cancelled(){
+//-----------------------------------------------------
+  yieldOnTime();
+  while (!cancel && Serial.available()){
+    if (Serial.read() == CANCEL_CHAR){
+      Serial.println("^C");
+      cancel = true;
+    }
+  }
+  return cancel;
+}
+
 //-----------------------------------------------------
 void LittleFS_CommandLineInterface::showSplitedCmd(){                              
 //-----------------------------------------------------
@@ -123,36 +156,51 @@ String LittleFS_CommandLineInterface::findWorkDir(String path){
   return path.length() > 0 ? path : "/";
 }
 
+// Temporary and index files are not listed, copied or deleted by the directory commands,
+// and can not be the target of the file writing commands
+//-----------------------------------------------------
+bool LittleFS_CommandLineInterface::reservedFile(String path){
+//-----------------------------------------------------
+  path.replace("//", "/");
+  return path == TEMP_FILE || path == INDEX_FILE;
+}
+
 //-----------------------------------------------------        
 bool LittleFS_CommandLineInterface::patternMatch(String path, String pattern){     
+//-----------------------------------------------------          
+  return patternMatch(path.c_str(), pattern.c_str());
+}
+
+// Closing '\0' characters are compared too
+//-----------------------------------------------------        
+bool LittleFS_CommandLineInterface::patternMatch(const char *path, const char *pattern){     
 //-----------------------------------------------------          
   bool same      = true;
   bool starFlag  = false;
   int patternIdx = 0;
   int pathIdx    = 0;
+  int patternLength = strlen(pattern) + 1;
+  int pathLength    = strlen(path) + 1;
   
-  if (pattern.length() == 0){
+  if (patternLength == 1){
     return true;
   }
 
-  path += '\0';
-  pattern += '\0';
-
-  while(same && patternIdx < pattern.length() && pathIdx < path.length()){
+  while(same && patternIdx < patternLength && pathIdx < pathLength){
 
-    if (pattern.charAt(patternIdx) == '?'){  patternIdx++;    pathIdx++;    continue;  } 
-    if (pattern.charAt(patternIdx) == '*'){  starFlag = true; patternIdx++; continue;  }  
+    if (pattern[patternIdx] == '?'){  patternIdx++;    pathIdx++;    continue;  } 
+    if (pattern[patternIdx] == '*'){  starFlag = true; patternIdx++; continue;  }  
     if (starFlag){  
-      while (pathIdx < path.length() && pattern.charAt(patternIdx) != path.charAt(pathIdx)) pathIdx++;   
+      while (pathIdx < pathLength && pattern[patternIdx] != path[pathIdx]) pathIdx++;   
       starFlag = false;     continue;  
     }
-    if (pattern.charAt(patternIdx) != path.charAt(pathIdx)) {  same = false;    continue;    }
+    if (pattern[patternIdx] != path[pathIdx]) {  same = false;    continue;    }
         
     patternIdx++;
     pathIdx++;
   }
   
-  if (pathIdx == path.length() && patternIdx == pattern.length())
+  if (pathIdx == pathLength && patternIdx == patternLength)
     return true;
   else
     return false;
@@ -225,14 +273,14 @@ void LittleFS_CommandLineInterface::tree(String path, int level){
   String branch = "|-- ";
   
   Dir dir = LittleFS.openDir(path);
-  while (dir.next()) {            
-    if (dir.isFile()){
+  while (!cancelled() && dir.next()) {            
+    if (dir.isFile() && !reservedFile(path + '/' + dir.fileName())){
       Serial.print(pad(branch,3+level*4,' ','L'));
       Serial.println(dir.fileName());
     }
   }
   dir = LittleFS.openDir(path);
-  while (dir.next()) {            
+  while (!cancelled() && dir.next()) {            
     if (dir.isDirectory()){
       Serial.print(pad(branch,3+level*4,' ','L'));
       Serial.println(dir.fileName() + "  <dir>");
@@ -243,45 +291,365 @@ void LittleFS_CommandLineInterface::tree(String path, int level){
   return;
 }
 
+// Order of dir listing. Bigger size and newer time are first, equals are ordered by name.
+//-----------------------------------------------------
+int LittleFS_CommandLineInterface::compareEntry(const DirEntry &a, const DirEntry &b, char sortKey){
+//-----------------------------------------------------
+  int result = 0;
+
+  if (sortKey == 's') result = (a.size < b.size) - (a.size > b.size);
+  if (sortKey == 't') result = (a.time < b.time) - (a.time > b.time);
+  if (result == 0)    result = strcmp(a.name, b.name);
+  return result;
+}
+
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::printEntry(const DirEntry &entry, bool longFormat){
+//-----------------------------------------------------
+  char line[PATH_LENGTH + 64];
+  char timeStr[20] = "";
+  int  length;
+
+  if (longFormat && entry.time > 0){
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M", localtime(&entry.time));
+  }
+
+  if (entry.isDir){
+    length = snprintf(line, sizeof(line), longFormat ? "%-35s%-16s  %s\r\n" : "%-35s%s\r\n", entry.name, "<dir>", timeStr);
+  }else{
+    length = snprintf(line, sizeof(line), longFormat ? "%-35s%10lu bytes  %s\r\n" : "%-35s%10lu bytes\r\n", entry.name, (unsigned long)entry.size, timeStr);
+  }
+  Serial.write((const uint8_t*)line, min(length, (int)sizeof(line) - 1));
+}
+
+// Lists directory in sortKey order ('n' name, 's' size, 't' time, 0 unsorted).
+// One directory scan sorts DIR_PAGE_SIZE entries, the directory is scanned again only if it has more.
+// If there is not enough memory for DIR_PAGE_SIZE entries, page is smaller.
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::listDir(String path, char sortKey, bool longFormat){
+//-----------------------------------------------------
+  DirEntry *page    = NULL;
+  int      pageSize = DIR_PAGE_SIZE;
+  DirEntry entry, last;
+  Dir      dir;
+  bool     hasLast   = false;
+  bool     morePage;
+  int      count;
+  int      fileCount = 0;
+  int      dirCount  = 0;
+  uint64_t sumSize   = 0;
+
+  if (sortKey != 0){
+    while (pageSize > 0 && (page = (DirEntry*)malloc(pageSize * sizeof(DirEntry))) == NULL){
+      pageSize /= 2;
+    }
+    if (page == NULL){
+      Serial.println("Not enough memory for sorting!");
+      return;
+    }
+  }
+
+  do{
+    count    = 0;
+    morePage = false;
+
+    dir = LittleFS.openDir(path);
+    while (!cancelled() && dir.next()) {
+      strncpy(entry.name, dir.fileName().c_str(), PATH_LENGTH);
+      entry.name[PATH_LENGTH] = '\0';
+      if (!patternMatch(entry.name, pathPattern.c_str())){
+        continue;
+      }
+      if (entry.name[0] == '~' && reservedFile(path + "/" + entry.name)){
+        continue;
+      }
+      entry.isDir = dir.isDirectory();
+      entry.size  = entry.isDir ? 0 : dir.fileSize();
+      entry.time  = longFormat || sortKey == 't' ? dir.fileTime() : 0;
+
+      // Unsorted list is written out in directory order
+      if (sortKey == 0){
+        printEntry(entry, longFormat);
+        entry.isDir ? dirCount++ : fileCount++;
+        sumSize += entry.size;
+        continue;
+      }
+
+      // Listed in a previous page
+      if (hasLast && compareEntry(entry, last, sortKey) <= 0){
+        continue;
+      }
+      // Page is full, the last one goes to the next page
+      if (count == pageSize){
+        morePage = true;
+        if (compareEntry(entry, page[count - 1], sortKey) >= 0){
+          continue;
+        }
+        count--;
+      }
+      // Sorted insert
+      int i = count++;
+      while (i > 0 && compareEntry(entry, page[i - 1], sortKey) < 0){
+        page[i] = page[i - 1];
+        i--;
+      }
+      page[i] = entry;
+    }
+
+    for (int i = 0; i < count; i++){
+      printEntry(page[i], longFormat);
+      page[i].isDir ? dirCount++ : fileCount++;
+      sumSize += page[i].size;
+    }
+    if (count > 0){
+      last    = page[count - 1];
+      hasLast = true;
+    }
+  }while(morePage && !cancel);
+  free(page);
+
+  Serial.println("\n"+pad(String(fileCount),25,' ','L') + (fileCount > 1 ? " files    "   : " file     ") + pad(String((unsigned long long)sumSize),10,' ','L') + " bytes");
+  Serial.println(     pad(String(dirCount),25,' ','L')  + (dirCount > 1  ? " directories" : " directory"));
+}
+
+// Writes out the file, if name matches the pattern and size matches the size condition.
+// sizeOp: '+' bigger, '-' smaller, '=' equal, 0 no size condition
+//-----------------------------------------------------
+bool LittleFS_CommandLineInterface::findFile(String path, long fileSize, String pattern, char sizeOp, long size){
+//-----------------------------------------------------
+  if (!patternMatch(path.substring(path.lastIndexOf('/') + 1), pattern)){
+    return false;
+  }
+  if ((sizeOp == '+' && fileSize <= size) || (sizeOp == '-' && fileSize >= size) || (sizeOp == '=' && fileSize != size)){
+    return false;
+  }
+  Serial.println(pad(path,35,' ','R') + pad(String(fileSize),10,' ','L') + " bytes");
+  return true;
+}
+
+// Walks the directory tree without recursion, only one open directory per level.
+// If index is given, every file is written into it, else matching files are written out.
+//-----------------------------------------------------
+int LittleFS_CommandLineInterface::walkFiles(String root, String pattern, char sizeOp, long size, File *index){
+//-----------------------------------------------------
+  Dir    dirs[MAX_DEPTH];
+  String path  = root == "/" ? "" : root;
+  String entryPath;
+  int    level = 0;
+  int    count = 0;
+
+  dirs[0] = LittleFS.openDir(root);
+  while (level >= 0 && !cancelled()){
+    // Directory end, back to the parent
+    if (!dirs[level].next()){
+      dirs[level--] = Dir();
+      if (level >= 0) path = path.substring(0, path.lastIndexOf('/'));
+      continue;
+    }
+
+    entryPath = path + "/" + dirs[level].fileName();
+    if (dirs[level].isDirectory()){
+      if (level < MAX_DEPTH - 1){
+        dirs[++level] = LittleFS.openDir(entryPath);
+        path = entryPath;
+      }
+      continue;
+    }
+    if (reservedFile(entryPath)){
+      continue;
+    }
+
+    if (index){
+      index->print(entryPath + "\t" + String(dirs[level].fileSize()) + "\n");
+      count++;
+    }else if (findFile(entryPath, dirs[level].fileSize(), pattern, sizeOp, size)){
+      count++;
+    }
+  }
+  return count;
+}
+
+// Index file lines: path<tab>size
+//-----------------------------------------------------
+int LittleFS_CommandLineInterface::findInIndex(String root, String pattern, char sizeOp, long size){
+//-----------------------------------------------------
+  String line;
+  int    tab;
+  int    count = 0;
+
+  File f = LittleFS.open(INDEX_FILE, "r");
+  if (!f) {
+    Serial.println(String(INDEX_FILE) + " file open failed!");
+    return 0;
+  }
+  while (!cancelled() && f.available()){
+    line = f.readStringUntil('\n');
+    tab  = line.lastIndexOf('\t');
+    if (tab == -1 || (root != "/" && !line.startsWith(root + "/"))){
+      continue;
+    }
+    if (findFile(line.substring(0, tab), line.substring(tab + 1).toInt(), pattern, sizeOp, size)){
+      count++;
+    }
+  }
+  f.close();
+  return count;
+}
+
+// Collects the index changes of a command, they are written by indexFlush once.
+// Full batch is written at once.
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::indexChange(char type, String path, String newPath){
+//-----------------------------------------------------
+  if (!LittleFS.exists(INDEX_FILE)){
+    return;
+  }
+  if (indexChangeCount == INDEX_BATCH){
+    indexFlush();
+  }
+  path.replace("//", "/");
+  newPath.replace("//", "/");
+  indexChanges[indexChangeCount].type    = type;
+  indexChanges[indexChangeCount].path    = path;
+  indexChanges[indexChangeCount].newPath = newPath;
+  indexChangeCount++;
+}
+
+// Path after the changes from the given one, empty if it was deleted or added again.
+// Rename overwrites the target, so index lines of the target are dropped.
+//-----------------------------------------------------
+String LittleFS_CommandLineInterface::indexApply(String path, int from){
+//-----------------------------------------------------
+  for (int i = from; i < indexChangeCount && path.length() > 0; i++){
+    IndexChange &change = indexChanges[i];
+    bool same  = path == change.path;
+    bool under = same || path.startsWith(change.path + "/");
+
+    if (change.type == 'R' && under){
+      path = change.newPath + path.substring(change.path.length());
+    }else if (change.type == 'R' && (path == change.newPath || path.startsWith(change.newPath + "/"))){
+      path = "";
+    }else if ((change.type == 'D' && under) || (change.type == 'A' && same)){
+      path = "";
+    }
+  }
+  return path;
+}
+
+// Rewrites the index with the collected changes in one pass, into the temporary file, then renamed.
+// Added files get their current size.
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::indexFlush(){
+//-----------------------------------------------------
+  File   f_in, f_out;
+  String line, path;
+  int    tab;
+
+  if (indexChangeCount == 0){
+    return;
+  }
+  if (!LittleFS.exists(INDEX_FILE)){
+    indexChangeCount = 0;
+    return;
+  }
+
+  f_in  = LittleFS.open(INDEX_FILE, "r");
+  f_out = LittleFS.open(TEMP_FILE, "w");
+  if (!f_in || !f_out) {
+    Serial.println(String(INDEX_FILE) + " file update failed!");
+    f_in.close();
+    f_out.close();
+    indexChangeCount = 0;
+    return;
+  }
+  // Not cancellable, a partly updated index would be wrong
+  while (f_in.available()){
+    yieldOnTime();
+    line = f_in.readStringUntil('\n');
+    tab  = line.lastIndexOf('\t');
+    if (tab == -1){
+      continue;
+    }
+    path = indexApply(line.substring(0, tab), 0);
+    if (path.length() > 0){
+      f_out.print(path + line.substring(tab) + "\n");
+    }
+  }
+  for (int i = 0; i < indexChangeCount; i++){
+    yieldOnTime();
+    if (indexChanges[i].type != 'A'){
+      continue;
+    }
+    path = indexApply(indexChanges[i].path, i + 1);
+    if (path.length() == 0){
+      continue;
+    }
+    File f = LittleFS.open(path, "r");
+    if (f && f.isFile()){
+      f_out.print(path + "\t" + String(f.size()) + "\n");
+    }
+    f.close();
+  }
+  f_out.flush();
+  f_out.close();
+  f_in.close();
+  indexChangeCount = 0;
+  commitTempFile(INDEX_FILE);
+}
+
+// Writes out length bytes from the offset, length -1 means to the end of file
 //-----------------------------------------------------        
-void LittleFS_CommandLineInterface::typeHexa(String path){                         
+void LittleFS_CommandLineInterface::typeHexa(String path, long offset, long length){                         
 //-----------------------------------------------------          
-  int ch, c;
+  uint8_t chunk[BUFFER_SIZE];
+  uint8_t buffer[20];
   long byteCounter = 0;
-  long byteCountTitle = 0;
-  char buffer[20];
+  long byteCountTitle = offset;
+  long remaining;
+  size_t size;
   int idx = 0;
 
   File f = LittleFS.open(path, "r");
   if (!f) {
     Serial.println(cmd[1] + " file open failed!");
   } else {
+    if (offset > (long)f.size()){
+      Serial.println(String(offset) + " offset is beyond the end of file!");
+      f.close();
+      return;
+    }
+    f.seek(offset, SeekSet);
+    remaining = f.size() - offset;
+    if (length >= 0 && length < remaining) remaining = length;
+
     for (int i = 0; i < 20; i++){                  
           buffer[i] = 0;
     }
 
-    while (f.available()) {
-      ch = f.read();
-      byteCounter++;
-      buffer[idx++] = ch;
-      if (!(byteCounter % 20) || !f.available()){
-        Serial.print(pad((String)(byteCountTitle),6,' ','L') + " | "); 
-        // write hexa
-        for (int i = 0; i < 20; i++){
-          if (buffer[i] < 16) Serial.print('0');
-          Serial.print(buffer[i], HEX);
-          Serial.print(' ');
-          if (i == 9) Serial.print("| ");
-        }
-        // write characters
-        Serial.print("| ");
-        for (int i = 0; i < 20; i++){                  
-          buffer[i] >= 32 ? Serial.print(buffer[i]) : Serial.print(' ');
-          buffer[i] = 0;
+    while (remaining > 0 && !cancelled() && (size = f.read(chunk, min(remaining, (long)BUFFER_SIZE))) > 0) {
+      remaining -= size;
+      for (size_t k = 0; k < size; k++){
+        byteCounter++;
+        buffer[idx++] = chunk[k];
+        if (!(byteCounter % 20) || (remaining == 0 && k == size - 1)){
+          Serial.print(pad((String)(byteCountTitle),6,' ','L') + " | "); 
+          // write hexa
+          for (int i = 0; i < 20; i++){
+            if (buffer[i] < 16) Serial.print('0');
+            Serial.print(buffer[i], HEX);
+            Serial.print(' ');
+            if (i == 9) Serial.print("| ");
+          }
+          // write characters
+          Serial.print("| ");
+          for (int i = 0; i < 20; i++){                  
+            buffer[i] >= 32 && buffer[i] < 127 ? Serial.print((char)buffer[i]) : Serial.print(' ');
+            buffer[i] = 0;
+          }
+          Serial.println("");
+          idx = 0;
+          byteCountTitle += 20;
         }
-        Serial.println("");
-        idx = 0;
-        byteCountTitle += 20;
       }
     }
     f.close();
@@ -289,23 +657,57 @@ void LittleFS_CommandLineInterface::typeHexa(String path){
   }        
 }
 
+// New line modes: 'R' raw, no translation, 'C' line ends written as \r\n, 'L' line ends written as \n.
+// \r, \n, \r\n and \n\r are all one line end in the file.
+// Writes out length bytes from the offset, length -1 means to the end of file
 //-----------------------------------------------------        
-void LittleFS_CommandLineInterface::type(String path){                             
+void LittleFS_CommandLineInterface::type(String path, char newLine, long offset, long length){                             
 //-----------------------------------------------------          
-  int ch;
+  uint8_t buffer[BUFFER_SIZE];
+  uint8_t out[2 * BUFFER_SIZE];
+  int  prevBreak = 0;
+  long remaining;
+  size_t size, outSize;
 
   File f = LittleFS.open(path, "r");
   if (!f) {
     Serial.println(cmd[1] + " file open failed!");
   } else {
-    while (f.available()) {
-      ch = f.read();
-      if (ch == '\r') Serial.write('\n');
-      if (ch == '\n') continue;
-      Serial.write(ch);
+    if (offset > (long)f.size()){
+      Serial.println(String(offset) + " offset is beyond the end of file!");
+      f.close();
+      return;
+    }
+    f.seek(offset, SeekSet);
+    remaining = f.size() - offset;
+    if (length >= 0 && length < remaining) remaining = length;
+
+    while (remaining > 0 && !cancelled() && (size = f.read(buffer, min(remaining, (long)BUFFER_SIZE))) > 0) {
+      remaining -= size;
+      if (newLine == 'R'){
+        Serial.write(buffer, size);
+        continue;
+      }
+      outSize = 0;
+      for (size_t i = 0; i < size; i++){
+        if (buffer[i] != '\r' && buffer[i] != '\n'){
+          prevBreak = 0;
+          out[outSize++] = buffer[i];
+          continue;
+        }
+        // Second character of \r\n or \n\r
+        if (prevBreak != 0 && prevBreak != buffer[i]){
+          prevBreak = 0;
+          continue;
+        }
+        prevBreak = buffer[i];
+        if (newLine == 'C') out[outSize++] = '\r';
+        out[outSize++] = '\n';
+      }
+      Serial.write(out, outSize);
     }
     f.close();
-    Serial.println("");
+    if (newLine != 'R') Serial.println("");
   }        
 }
 
@@ -314,7 +716,14 @@ void LittleFS_CommandLineInterface::type(String path){
 void LittleFS_CommandLineInterface::copyOneFile(String inPath, String outPath){                             
 //-----------------------------------------------------          
   File f_in, f_out;
+  uint8_t buffer[BUFFER_SIZE];
+  size_t size;
+  bool writeError = false;
 
+  if (reservedFile(outPath)){
+    Serial.println(outPath + " file name is reserved!");
+    return;
+  }
   if (f_out = LittleFS.open(outPath, "r")){
     Serial.println(outPath+" file already exists!");
     f_out.close();
@@ -327,19 +736,112 @@ void LittleFS_CommandLineInterface::copyOneFile(String inPath, String outPath){
     return;
   }
 
-  f_out = LittleFS.open(outPath, "w");
+  f_out = LittleFS.open(TEMP_FILE, "w");
   if (!f_out) {
     Serial.println(outPath + " file write open failed!");
     f_in.close();
     return;
   }
 
-  while (f_in.available()) {
-    f_out.write(f_in.read());
+  while (!writeError && !cancelled() && (size = f_in.read(buffer, BUFFER_SIZE)) > 0) {
+    if (f_out.write(buffer, size) != size) writeError = true;
   }
   f_out.flush();
   f_out.close();
   f_in.close();
+
+  // Partial file is not kept
+  if (cancel){
+    LittleFS.remove(TEMP_FILE);
+    return;
+  }
+
+  if (writeError){
+    Serial.println(outPath + " file write failed!");
+    LittleFS.remove(TEMP_FILE);
+    return;
+  }
+  if (commitTempFile(outPath)){
+    indexChange('A', outPath, "");
+  }
+}
+
+// Removes the temporary file, what remained after an interrupted write
+//-----------------------------------------------------
+void LittleFS_CommandLineInterface::cleanTempFile(){
+//-----------------------------------------------------
+  if (LittleFS.exists(TEMP_FILE)){
+    LittleFS.remove(TEMP_FILE);
+  }
+}
+
+// Moves the completely written temporary file to its place. Rename is atomic,
+// the target file is either the old or the new one even if power lost.
+//-----------------------------------------------------
+bool LittleFS_CommandLineInterface::commitTempFile(String path){
+//-----------------------------------------------------
+  int slash = path.indexOf('/', 1);
+
+  // Rename does not create the path, like open does
+  while (slash != -1){
+    if (!LittleFS.exists(path.substring(0, slash))){
+      LittleFS.mkdir(path.substring(0, slash));
+    }
+    slash = path.indexOf('/', slash + 1);
+  }
+
+  if (!LittleFS.rename(TEMP_FILE, path)){
+    Serial.println(path + " file rename failed!");
+    LittleFS.remove(TEMP_FILE);
+    return false;
+  }
+  return true;
+}
+
+// Reads clipboard content from serial port into the file at its current position.
+// Writes to the file in BUFFER_SIZE pieces. Returns the written byte count, or -1 if write failed.
+//-----------------------------------------------------
+long LittleFS_CommandLineInterface::receiveToFile(File &f, bool bin){
+//-----------------------------------------------------
+  uint8_t buffer[BUFFER_SIZE];
+  int  ch;
+  int  idx           = 0;
+  long byteCounter   = 0;
+  bool writeError    = false;
+  bool beginReadFlag = false;
+  long pauseCounter  = 0;
+
+  Serial.print("Insert from clipboard!");
+
+  do{
+      if (Serial.available()){
+        beginReadFlag = true;
+        pauseCounter = 0;
+        ch = Serial.read();
+        if ( !bin && ch == NEW_LINE_CHAR ) { // new line character convert
+          buffer[idx++] = '\n'; buffer[idx++] = '\r';
+        }else{
+          buffer[idx++] = ch;
+        }
+        // Keeps place for two characters of new line
+        if (idx >= BUFFER_SIZE - 1){
+          if (f.write(buffer, idx) != (size_t)idx) writeError = true;
+          byteCounter += idx;
+          idx = 0;
+        }
+      }
+      if (beginReadFlag) pauseCounter++;
+      yieldOnTime();
+  }while(pauseCounter < 10000);
+
+  if (idx > 0){
+    if (f.write(buffer, idx) != (size_t)idx) writeError = true;
+    byteCounter += idx;
+  }
+  f.flush();
+  Serial.print("\r                                                 \r");
+
+  return writeError ? -1 : byteCounter;
 }
 
 //-----------------------------------------------------
@@ -435,7 +937,8 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     Serial.println(" Command line interface is case-sensitive.");
     Serial.println(" If path not specified uses the work directory. Path separator is the slash character."); 
     Serial.println(" It has command history with ten elements."); 
-	Serial.println(" Able to load file content from clipboard.\n");
+	Serial.println(" Able to load file content from clipboard.");
+    Serial.println(" Loaded and copied files are written to a temporary file first, so a power loss does not leave a half-written file.\n");
 	
     Serial.println("\n-- Commands ---------------------------------------\n");
     Serial.println("  help");
@@ -447,18 +950,23 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     Serial.println("  rmdir [path/]name");
     Serial.println("             Removes directory. Directory must be under work directory.");
     Serial.println("             Only empty directory can be deleted. (Does full path delete, if parent directory is empty too)\n");
-    Serial.println("  dir [path[/fileNamePattern]]");
+    Serial.println("  dir [-n|-s|-t] [-l] [path[/fileNamePattern]]");
     Serial.println("             Lists directory content. File name can be given by pattern too.");
-    Serial.println("             (? = one character, * = more characters)\n" );
+    Serial.println("             (? = one character, * = more characters)" );
+    Serial.println("             Sorted by name (-n), by size (-s, biggest first) or by time (-t, newest first).");
+    Serial.println("             With \"-l\" last write time is shown too.\n" );
     Serial.println("  tree [path]");
     Serial.println("             Shows directory tree.\n");
     Serial.println("  cd [path]");
     Serial.println("             Changes work directory.\n");
-    Serial.println("  load [path/]fileName");
+    Serial.println("  load [-a] [path/]fileName [bin]");
     Serial.println("             Creates a file with specific name and loads content of clipboard into the file.");
-    Serial.println("             Creates the path, if not exists yet.");
+    Serial.println("             Creates the path, if not exists yet. With \"-a\" appends content to the end of the file.");
     Serial.println("             At the Arduino IDE, new line characters must be replaced with '^' character before load.");
-    Serial.println("             At the PuTTY, clipboard content can be inserted with right mouse button click.\n");
+    Serial.println("             At the PuTTY, clipboard content can be inserted with right mouse button click.");
+    Serial.println("             If \"bin\" parameter is given, then '^' character is not converted.\n");
+    Serial.println("  patch [path/]fileName offset [bin]");
+    Serial.println("             Overwrites file content from the offset with content of clipboard. File must be existed.\n");
     Serial.println("  del [path][/fileNamePattern]");
     Serial.println("             Deletes specific file or files. File name can be given by pattern too.");
     Serial.println("             (? = one character, * = more characters)\n");
@@ -468,10 +976,26 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     Serial.println("             Copies file or files. \"From\" file name can be given by pattern too.");
     Serial.println("             (? = one character, * = more characters)" );
     Serial.println("             If fromFileName parameter specified by pattern, then toFileName parameter must be a directory.\n" );          
-    Serial.println("  type [path/]fileName [hex]");
-    Serial.println("             Writes out to screen the file content. If \"hex\" parameter is given too, then in hexadecimal format.\n");
+    Serial.println("  type [path/]fileName [hex] [-crlf|-lf|-raw|-gz] [-o offset] [-n length]");
+    Serial.println("             Writes out to screen the file content. If \"hex\" parameter is given too, then in hexadecimal format.");
+    Serial.println("             Line ends are written as \\r\\n (-crlf, default) or \\n (-lf). With \"-raw\" the content is not changed.");
+    Serial.println("             Writes out only length bytes from the offset, if \"-o\" or \"-n\" is given.");
+    Serial.println("             With \"-gz\" the whole file is sent in gzip format, other parameters can not be given with it.\n");
+    Serial.println("  gzip [path/]fileName");
+    Serial.println("             Compresses the file into fileName.gz and deletes the original.\n");
+    Serial.println("  gunzip [path/]fileName.gz");
+    Serial.println("             Decompresses the file and deletes the compressed one.");
+    Serial.println("             Files compressed elsewhere must use max 4 KB window.\n");
+    Serial.println("  find [path] [-name fileNamePattern] [-size [+|-]bytes]");
+    Serial.println("             Finds files in the path and under it. File name can be given by pattern.");
+    Serial.println("             (? = one character, * = more characters)");
+    Serial.println("             Size +N means bigger, -N smaller than N bytes, N exactly N bytes.\n");
+    Serial.println("  find -index [on|off]");
+    Serial.println("             Switches on or off the file name index. Find reads the index instead of the directories.");
+    Serial.println("             Index is updated by load, patch, copy, ren, del, gzip and gunzip commands.\n");
     Serial.println("  exit");
-    Serial.println("             Exits the interface program. Can do it with ctrl+D keystrokes too.\n");          
+    Serial.println("             Exits the interface program. Can do it with ctrl+D keystrokes too.");
+    Serial.println("             Long running commands (copy, del, dir, tree, type, find, gzip) can be cancelled with ctrl+C.\n");          
     Serial.println("  format");
     Serial.println("             Formats the file system. Deletes all content.\n");
     Serial.println("  begin");
@@ -517,34 +1041,24 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
   //.........................................
   if (cmd[0] == "dir"){                   
   //.........................................  
-    Dir dir;
-    int fileCount = 0;
-    int dirCount  = 0;
-    long size     = 0;
-    long sumSize  = 0;
-    
-    cmd[1] = pathValidate(cmd[1], 'B');
-    if (cmd[1].length() == 0){    return;      }
-
-    dir = LittleFS.openDir(cmd[1]);
-    while (dir.next()) {
-      if (!patternMatch(dir.fileName(),pathPattern)){
-        continue;
-      }
-      Serial.print(pad(dir.fileName(),35,' ','R'));
-      if (dir.isFile()){
-        size = dir.fileSize();              
-        Serial.println(pad(String(size),10,' ','L')+" bytes");
-        fileCount++;
-        sumSize += size;             
-      }
-      if (dir.isDirectory()){
-        Serial.println("<dir>");
-        dirCount++;
+    String path       = "";
+    char   sortKey    = 0;
+    bool   longFormat = false;
+
+    for (int i = 1; i < PARAM_COUNT && cmd[i].length() > 0; i++){
+      if (cmd[i] == "-n" || cmd[i] == "-s" || cmd[i] == "-t"){
+        sortKey = cmd[i].charAt(1);
+      }else if (cmd[i] == "-l"){
+        longFormat = true;
+      }else{
+        path = cmd[i];
       }
     }
-    Serial.println("\n"+pad(String(fileCount),25,' ','L') + (fileCount > 1 ? " files    "   : " file     ") + pad(String(sumSize),10,' ','L') + " bytes");
-    Serial.println(     pad(String(dirCount),25,' ','L')  + (dirCount > 1  ? " directories" : " directory"));
+
+    cmd[1] = pathValidate(path, 'B');
+    if (cmd[1].length() == 0){    return;      }
+
+    listDir(cmd[1], sortKey, longFormat);
     return;          
   }
 
@@ -582,53 +1096,139 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
   //.........................................
   if (cmd[0] == "type" && cmd[1].length() > 0){  
   //.........................................
+    bool hexa       = false;
+    bool compressed = false;
+    char newLine    = 'C';
+    long offset  = 0;
+    long length  = -1;
+    long value;
+
     cmd[1] = pathValidate(cmd[1], 'F');
     if (cmd[1].length() == 0){   return;    }
 
-    if (cmd[2] == "hex"){
-      typeHexa(cmd[1]);
+    for (int i = 2; i < PARAM_COUNT && cmd[i].length() > 0; i++){
+      if      (cmd[i] == "hex")   { hexa = true;   }
+      else if (cmd[i] == "-raw")  { newLine = 'R'; }
+      else if (cmd[i] == "-crlf") { newLine = 'C'; }
+      else if (cmd[i] == "-lf")   { newLine = 'L'; }
+      else if (cmd[i] == "-gz")   { compressed = true; }
+      else if ((cmd[i] == "-o" || cmd[i] == "-n") && i < PARAM_COUNT - 1){
+        value = cmd[i+1].toInt();
+        if (String(value) != cmd[i+1] || value < 0){
+          Serial.println(cmd[i+1] + " wrong number!");
+          return;
+        }
+        cmd[i] == "-o" ? offset = value : length = value;
+        i++;
+      }else{
+        Serial.println(cmd[i] + " wrong parameter!");
+        return;
+      }
+    }
+    // Whole file is compressed as it is, other modes do not apply
+    for (int i = 2; compressed && i < PARAM_COUNT && cmd[i].length() > 0; i++){
+      if (cmd[i] != "-gz"){
+        Serial.println(cmd[i] + " wrong parameter!");
+        return;
+      }
+    }
+
+    if (compressed){
+      LittleFS_Gzip gzip;
+      gzip.onCancel([this](){ return cancelled(); });
+      File f = LittleFS.open(cmd[1], "r");
+      if ((!f || !gzip.compress(f, Serial)) && !cancel){
+        Serial.println(gzip.outOfMemory() ? "Not enough memory for compression!" : cmd[1] + " file compress failed!");
+      }
+      f.close();
+    } else if (hexa){
+      typeHexa(cmd[1], offset, length);
     } else {
-      type(cmd[1]);
+      type(cmd[1], newLine, offset, length);
     }
     return;          
   }
 
   //.........................................        
-  if (cmd[0] == "load" && cmd[1].length() > 0) {   
+  if (cmd[0] == "load" && cmd[1].length() > 0) {
   //.........................................
-    int ch;
-    bool beginReadFlag = false;
-    long pauseCounter  = 0;           
-    
+    bool append = false;
+
+    // Append mode, shifts the parameters
+    if (cmd[1] == "-a"){
+      append = true;
+      for (int i = 1; i < PARAM_COUNT - 1; i++){ cmd[i] = cmd[i+1]; }
+      cmd[PARAM_COUNT - 1] = "";
+      if (cmd[1].length() == 0){  return;   }
+    }
+
     cmd[1] = pathValidate(cmd[1], 'B');
     if (cmd[1].length() == 0){  return;   }
-    
-    File f = LittleFS.open(cmd[1], "w");
+    if (reservedFile(cmd[1])){
+      Serial.println(cmd[1] + " file name is reserved!");
+      return;
+    }
+
+    // New content goes to the temporary file, appended content directly to the file
+    File f = LittleFS.open(append ? cmd[1] : TEMP_FILE, append ? "a" : "w");
     if (!f) {
       Serial.println(cmd[1] + " file open failed!");
     }else{
-      Serial.print("Insert from clipboard!");
-
-      do{
-          if (Serial.available()){
-            beginReadFlag = true;
-            pauseCounter = 0;                
-            ch = Serial.read();
-            if ( cmd[2] != "bin" && ch == NEW_LINE_CHAR ) { // new line character convert
-              f.write('\n'); f.write('\r'); 
-            }else{
-              f.write(ch);
-            }
-          }
-          if (beginReadFlag) pauseCounter++;
-      }while(pauseCounter < 10000);
+      long size = receiveToFile(f, cmd[2] == "bin");
+      f.close();
+      if (size < 0){
+        Serial.println(cmd[1] + " file write failed!");
+        if (!append) LittleFS.remove(TEMP_FILE);
+      }else if (append){
+        indexChange('A', cmd[1], "");
+        Serial.println(cmd[1] + " file appended\r\n");
+      }else if (commitTempFile(cmd[1])){
+        indexChange('A', cmd[1], "");
+        Serial.println(cmd[1] + " file created\r\n");
+      }
+    }
+    return;
+  }
+
+  //.........................................
+  if (cmd[0] == "patch" && cmd[1].length() > 0 && cmd[2].length() > 0) {
+  //.........................................
+    long offset;
+
+    cmd[1] = pathValidate(cmd[1], 'F');
+    if (cmd[1].length() == 0){  return;   }
+    if (reservedFile(cmd[1])){
+      Serial.println(cmd[1] + " file name is reserved!");
+      return;
+    }
 
-      f.flush();
+    offset = cmd[2].toInt();
+    if (String(offset) != cmd[2] || offset < 0){
+      Serial.println(cmd[2] + " wrong offset!");
+      return;
+    }
+
+    File f = LittleFS.open(cmd[1], "r+");
+    if (!f) {
+      Serial.println(cmd[1] + " file open failed!");
+      return;
+    }
+    if (offset > (long)f.size()){
+      Serial.println(cmd[2] + " offset is beyond the end of file!");
       f.close();
-      Serial.print("\r                                                 \r");
-      Serial.println(cmd[1]+" file created\r\n");
+      return;
     }
-    return;          
+
+    f.seek(offset, SeekSet);
+    long size = receiveToFile(f, cmd[3] == "bin");
+    f.close();
+    if (size < 0){
+      Serial.println(cmd[1] + " file write failed!");
+    }else{
+      indexChange('A', cmd[1], "");
+      Serial.println(cmd[1] + " file patched, " + String(size) + " bytes written\r\n");
+    }
+    return;
   }
 
   //.........................................        
@@ -645,15 +1245,18 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
         Serial.println(cmd[1] + " file delete failed!");
         return;
       }
+      indexChange('D', cmd[1], "");
     }else{  
       dir = LittleFS.openDir(cmd[1]);
-      while (dir.next()) {
+      while (!cancelled() && dir.next()) {
         fileName = dir.fileName();
-        if (!patternMatch(fileName,pathPattern) || dir.isDirectory()){
+        if (!patternMatch(fileName,pathPattern) || dir.isDirectory() || reservedFile(cmd[1]+"/"+fileName)){
           continue;
         }
         if (!LittleFS.remove(cmd[1]+"/"+fileName)){
           Serial.println(fileName + " file delete failed!");
+        }else{
+          indexChange('D', cmd[1]+"/"+fileName, "");
         }
       }
     }
@@ -670,9 +1273,15 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     cmd[2] = pathValidate(cmd[2], 'B');
     if (cmd[2].length() == 0){    return;   }
 
+    if (reservedFile(cmd[1]) || reservedFile(cmd[2])){
+      Serial.println((reservedFile(cmd[1]) ? cmd[1] : cmd[2]) + " file name is reserved!");
+      return;
+    }
     if (!LittleFS.rename(cmd[1], cmd[2])){
       Serial.println(cmd[1] + " file rename failed!");
+      return;
     }
+    indexChange('R', cmd[1], cmd[2]);
     return;
   }
 
@@ -698,9 +1307,9 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
       if (cmd[2].length() == 0){  return;  }            
 
       dir = LittleFS.openDir(cmd[1]);
-      while (dir.next()) {
+      while (!cancelled() && dir.next()) {
         fileName = dir.fileName();
-        if (!patternMatch(fileName, pattern) || dir.isDirectory()){
+        if (!patternMatch(fileName, pattern) || dir.isDirectory() || reservedFile(cmd[1]+"/"+fileName)){
           continue;
         }
         copyOneFile(cmd[1]+"/"+fileName, cmd[2]+"/"+fileName);
@@ -709,6 +1318,148 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     return;
   }
 
+  //.........................................        
+  if ((cmd[0] == "gzip" || cmd[0] == "gunzip") && cmd[1].length() > 0) {
+  //.........................................
+    LittleFS_Gzip gzip;
+    File   f_in, f_out;
+    String outPath;
+    size_t inSize, outSize;
+    bool   done;
+
+    cmd[1] = pathValidate(cmd[1], 'F');
+    if (cmd[1].length() == 0){  return;  }
+
+    if (cmd[0] == "gzip"){
+      outPath = cmd[1] + ".gz";
+    }else{
+      if (!cmd[1].endsWith(".gz")){
+        Serial.println(cmd[1] + " file name must end with .gz!");
+        return;
+      }
+      outPath = cmd[1].substring(0, cmd[1].length() - 3);
+    }
+    if (outPath.length() > PATH_LENGTH){
+      Serial.println(outPath+" to long! Max 32 character.");
+      return;
+    }
+    if (reservedFile(cmd[1]) || reservedFile(outPath)){
+      Serial.println((reservedFile(cmd[1]) ? cmd[1] : outPath) + " file name is reserved!");
+      return;
+    }
+    if (LittleFS.exists(outPath)){
+      Serial.println(outPath+" file already exists!");
+      return;
+    }
+
+    f_in = LittleFS.open(cmd[1], "r");
+    if (!f_in) {
+      Serial.println(cmd[1] + " file read open failed!");
+      return;
+    }
+    f_out = LittleFS.open(TEMP_FILE, "w");
+    if (!f_out) {
+      Serial.println(outPath + " file write open failed!");
+      f_in.close();
+      return;
+    }
+
+    gzip.onCancel([this](){ return cancelled(); });
+    done = cmd[0] == "gzip" ? gzip.compress(f_in, f_out) : gzip.decompress(f_in, f_out);
+    f_out.flush();
+    inSize  = f_in.size();
+    outSize = f_out.size();
+    f_out.close();
+    f_in.close();
+
+    if (!done){
+      if (gzip.outOfMemory()){
+        Serial.println(cmd[0] == "gzip" ? "Not enough memory for compression!" : "Not enough memory for decompression!");
+      }else if (!cancel){
+        Serial.println(cmd[1] + (cmd[0] == "gzip" ? " file compress failed!" : " file decompress failed!"));
+      }
+      LittleFS.remove(TEMP_FILE);
+      return;
+    }
+    // Original file is replaced by the result
+    if (commitTempFile(outPath)){
+      LittleFS.remove(cmd[1]);
+      indexChange('D', cmd[1], "");
+      indexChange('A', outPath, "");
+      Serial.println(outPath + " file created, " + String(inSize) + " -> " + String(outSize) + " bytes");
+    }
+    return;
+  }
+
+  //.........................................        
+  if (cmd[0] == "find") {
+  //.........................................
+    String path    = "";
+    String pattern = "";
+    String value;
+    char   sizeOp  = 0;
+    long   size    = 0;
+    int    count;
+
+    // Index on/off
+    if (cmd[1] == "-index"){
+      if (cmd[2] == "on"){
+        File f = LittleFS.open(TEMP_FILE, "w");
+        if (!f) {
+          Serial.println(String(INDEX_FILE) + " file write open failed!");
+          return;
+        }
+        count = walkFiles("/", "", 0, 0, &f);
+        f.flush();
+        f.close();
+        if (cancel){
+          LittleFS.remove(TEMP_FILE);
+        }else if (commitTempFile(INDEX_FILE)){
+          Serial.println(String(count) + (count > 1 ? " files indexed" : " file indexed"));
+        }
+      }else if (cmd[2] == "off"){
+        LittleFS.remove(INDEX_FILE);
+      }else{
+        Serial.println(LittleFS.exists(INDEX_FILE) ? "Index is on" : "Index is off");
+      }
+      return;
+    }
+
+    for (int i = 1; i < PARAM_COUNT && cmd[i].length() > 0; i++){
+      if (cmd[i] == "-name" && i < PARAM_COUNT - 1){
+        pattern = cmd[++i];
+      }else if (cmd[i] == "-size" && i < PARAM_COUNT - 1){
+        value  = cmd[++i];
+        sizeOp = '=';
+        if (value.startsWith("+") || value.startsWith("-")){
+          sizeOp = value.charAt(0);
+          value  = value.substring(1);
+        }
+        size = value.toInt();
+        if (String(size) != value || size < 0){
+          Serial.println(cmd[i] + " wrong size!");
+          return;
+        }
+      }else if (path.length() == 0 && !cmd[i].startsWith("-")){
+        path = cmd[i];
+      }else{
+        Serial.println(cmd[i] + " wrong parameter!");
+        return;
+      }
+    }
+
+    cmd[1] = pathValidate(path, 'D');
+    if (cmd[1].length() == 0){  return;  }
+
+    if (LittleFS.exists(INDEX_FILE)){
+      count = findInIndex(cmd[1], pattern, sizeOp, size);
+    }else{
+      count = walkFiles(cmd[1], pattern, sizeOp, size, NULL);
+    }
+    Serial.println("\n" + pad(String(count),25,' ','L') + (count > 1 ? " files found" : " file found"));
+    return;
+  }
+
   //.........................................        
   if (cmd[0] == "exit") {                 
   //.........................................
@@ -743,6 +1494,7 @@ void LittleFS_CommandLineInterface::cmdInterpreter(){
     if (!LittleFS.begin()){
       Serial.println("Mount file system failed!");
     }else{
+      cleanTempFile();
       Serial.println("Mount file system done!");
     }
     return;
@@ -11,9 +11,13 @@
 #define LittleFS_CommandLineInterface_h
 
 #include "LittleFS.h"
+#include "LittleFS_Gzip.h"
 #include <String.h>
+#include <time.h>
 
 #define VERSION "1.0.0" 
+#define TEMP_FILE "/~temp"    // Files are written here first, then renamed to their place
+#define INDEX_FILE "/~index"  // File name index of find command, exists only if index is switched on
 
 /*------------------------------------------------------------*/
 class LittleFS_CommandLineInterface{
@@ -22,7 +26,26 @@ class LittleFS_CommandLineInterface{
     const static int  PARAM_COUNT   = 10;
     const static int  PATH_LENGTH   = 32;
     const static int  HISTORY_COUNT = 10;
+    const static int  BUFFER_SIZE   = 256;  // LittleFS page size, file writes go in this size pieces
     const static char NEW_LINE_CHAR = '^';  // For loading from arduino IDE serial monitor
+    const static int  MAX_DEPTH     = PATH_LENGTH / 2;  // Deepest possible directory level
+    const static int  YIELD_TIME    = 50;   // ms, long commands give time to the system this often (watchdog, WiFi)
+    const static char CANCEL_CHAR   = 3;    // CTRL+C, cancels long commands
+    const static int  DIR_PAGE_SIZE = 128;  // Directory entries sorted in one scan (heap), bigger directory is listed in more pages
+    const static int  INDEX_BATCH   = 16;   // Index changes collected before the index file is rewritten
+
+    struct DirEntry{
+      char     name[PATH_LENGTH + 1];
+      uint32_t size;
+      time_t   time;
+      bool     isDir;
+    };
+
+    struct IndexChange{
+      char     type;     // 'A' add with current size, 'D' delete with paths under it, 'R' rename
+      String   path;
+      String   newPath;
+    };
 
     String     cmd[PARAM_COUNT];
     String     cmdHist[HISTORY_COUNT + 2];  // cmdHist[0] and cmdHist[HISTORY_COUNT+1] are delimiters, always empty
@@ -31,6 +54,10 @@ class LittleFS_CommandLineInterface{
     String     pathPattern;
     String     prompt;
     bool       exit;
+    bool       cancel;
+    unsigned long lastYield;
+    IndexChange indexChanges[INDEX_BATCH];
+    int        indexChangeCount;
 
   public:
            LittleFS_CommandLineInterface();
@@ -38,15 +65,31 @@ class LittleFS_CommandLineInterface{
 
   private:
     void   setWorkDir(String path);
+    void   yieldOnTime();
+    bool   cancelled();
     void   showSplitedCmd();
     String pad(String str, int length, char pad, char side);
     String findWorkDir(String path);
     bool   patternMatch(String path, String pattern);
+    bool   patternMatch(const char *path, const char *pattern);
+    bool   reservedFile(String path);
     String pathValidate(String path, char type);
     void   tree(String path, int level);
-    void   typeHexa(String path);
-    void   type(String path);
+    int    compareEntry(const DirEntry &a, const DirEntry &b, char sortKey);
+    void   printEntry(const DirEntry &entry, bool longFormat);
+    void   listDir(String path, char sortKey, bool longFormat);
+    bool   findFile(String path, long fileSize, String pattern, char sizeOp, long size);
+    int    walkFiles(String root, String pattern, char sizeOp, long size, File *index);
+    int    findInIndex(String root, String pattern, char sizeOp, long size);
+    void   indexChange(char type, String path, String newPath);
+    String indexApply(String path, int from);
+    void   indexFlush();
+    void   typeHexa(String path, long offset, long length);
+    void   type(String path, char newLine, long offset, long length);
     void   copyOneFile(String inPath, String outPath);
+    void   cleanTempFile();
+    bool   commitTempFile(String path);
+    long   receiveToFile(File &f, bool bin);
     void   cmdHistory(String cmd);
     String cmdHistoryControl(int arrowKey);
     void   splitLine(String cmdSlice, int idx);
@@ -0,0 +1,704 @@
+/*
+  LittleFS_Gzip.cpp - Streaming gzip compression for LittleFS command line interface.
+  Released into the public domain.
+
+  Gzip format: RFC 1952, deflate format: RFC 1951.
+  Matches are searched in a WINDOW_SIZE window through hash chains. The symbols are
+  collected into blocks, each block is written stored, with fixed or with dynamic
+  Huffman codes, whichever is the shortest.
+  Decompression accepts stored, fixed and dynamic blocks. Back references farther than
+  INFLATE_SIZE are refused.
+*/
+
+#include "LittleFS_Gzip.h"
+
+static const uint16_t LENGTH_BASE[29]  = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+static const uint8_t  LENGTH_EXTRA[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+static const uint16_t DIST_BASE[30]    = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+static const uint8_t  DIST_EXTRA[30]   = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+static const uint8_t  RLE_EXTRA[3]    = {2,3,7};  // Extra bits of code length symbols 16, 17, 18
+static const uint8_t  CODE_ORDER[19]   = {16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15};
+static const uint32_t CRC_TABLE[16]    = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                                          0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+//-----------------------------------------------------
+bool LittleFS_Gzip::compress(Stream &in, Print &out){
+//-----------------------------------------------------
+  static const uint8_t header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 3};
+  int  length     = 0;
+  int  pos        = 0;
+  int  blockStart = 0;
+  bool eof        = false;
+
+  Deflater *d = (Deflater*)malloc(sizeof(Deflater));
+  noMemory = d == NULL;
+  if (!d) return false;
+
+  begin(in, out);
+  for (int i = 0; i < HASH_SIZE; i++)   d->head[i] = NIL;
+  for (int i = 0; i < WINDOW_SIZE; i++) d->prev[i] = NIL;
+  d->symCount = 0;
+
+  for (int i = 0; i < 10; i++) putByte(header[i]);
+
+  while (!failed){
+    // Keeps MAX_MATCH bytes ahead of the position
+    if (!eof && length - pos < MAX_MATCH){
+      if (length == BUFFER_SIZE){
+        slideWindow(d);
+        length     -= WINDOW_SIZE;
+        pos        -= WINDOW_SIZE;
+        blockStart -= WINDOW_SIZE;
+      }
+      if (cancel && cancel()){
+        failed = true;
+        break;
+      }
+      int size = in.readBytes((char*)d->window + length, BUFFER_SIZE - length);
+      if (size <= 0) eof = true;
+      for (int i = 0; i < size; i++) updateCrc(d->window[length + i]);
+      totalSize += size > 0 ? size : 0;
+      length    += size > 0 ? size : 0;
+      continue;
+    }
+
+    // Block ends when its symbols are full, or at the end of input.
+    // Block can be stored only while its bytes are in the buffer.
+    if (d->symCount == SYMBOL_COUNT || pos >= length){
+      bool last = pos >= length;
+      writeBlock(d, blockStart >= 0 ? d->window + blockStart : NULL, pos - blockStart, last);
+      if (last) break;
+      blockStart  = pos;
+      d->symCount = 0;
+      continue;
+    }
+
+    int bestLength = 0;
+    int bestDist   = 0;
+
+    if (length - pos >= MIN_MATCH){
+      uint8_t *p     = d->window + pos;
+      int      hash  = ((p[0] << 6) ^ (p[1] << 3) ^ p[2]) & (HASH_SIZE - 1);
+      uint16_t candidate = d->head[hash];
+      int      maxLength = length - pos < MAX_MATCH ? length - pos : MAX_MATCH;
+
+      for (int chain = 0; candidate != NIL && chain < MAX_CHAIN; chain++){
+        int dist = pos - candidate;
+        if (dist <= 0 || dist >= WINDOW_SIZE) break;
+        int l = 0;
+        while (l < maxLength && d->window[candidate + l] == p[l]) l++;
+        if (l > bestLength){
+          bestLength = l;
+          bestDist   = dist;
+          if (l == maxLength) break;
+        }
+        candidate = d->prev[candidate & (WINDOW_SIZE - 1)];
+      }
+      d->prev[pos & (WINDOW_SIZE - 1)] = d->head[hash];
+      d->head[hash] = pos;
+    }
+
+    if (bestLength >= MIN_MATCH){
+      d->symValue[d->symCount] = bestLength - MIN_MATCH;
+      d->symDist[d->symCount++] = bestDist;
+      // Positions inside the match are also put into the hash chains
+      for (int i = pos + 1; i < pos + bestLength && length - i >= MIN_MATCH; i++){
+        uint8_t *p   = d->window + i;
+        int      hash = ((p[0] << 6) ^ (p[1] << 3) ^ p[2]) & (HASH_SIZE - 1);
+        d->prev[i & (WINDOW_SIZE - 1)] = d->head[hash];
+        d->head[hash] = i;
+      }
+      pos += bestLength;
+    }else{
+      d->symValue[d->symCount] = d->window[pos];
+      d->symDist[d->symCount++] = 0;
+      pos++;
+    }
+  }
+
+  putBits(0, (8 - bitCount) & 7);
+  for (int i = 0; i < 4; i++) putByte((crc ^ 0xFFFFFFFF) >> (8 * i));
+  for (int i = 0; i < 4; i++) putByte(totalSize >> (8 * i));
+  flushOutput();
+
+  free(d);
+  return !failed;
+}
+
+//-----------------------------------------------------
+bool LittleFS_Gzip::decompress(Stream &in, Print &out){
+//-----------------------------------------------------
+  uint32_t outPos = 0;
+  uint32_t value;
+  int      flags;
+  bool     last;
+
+  Inflater *d = (Inflater*)malloc(sizeof(Inflater));
+  noMemory = d == NULL;
+  if (!d) return false;
+
+  begin(in, out);
+
+  // Header
+  if (getBits(8) != 0x1F || getBits(8) != 0x8B || getBits(8) != 8) failed = true;
+  flags = getBits(8);
+  for (int i = 0; i < 6; i++) getBits(8);                    // time, extra flags, os
+  if (flags & 4){                                            // extra field
+    value = getBits(16);
+    while (value-- > 0 && !failed) getBits(8);
+  }
+  if (flags & 8)  while (getBits(8) != 0 && !failed);        // file name
+  if (flags & 16) while (getBits(8) != 0 && !failed);        // comment
+  if (flags & 2)  getBits(16);                               // header crc
+
+  // Blocks
+  do{
+    last = getBits(1);
+    switch (getBits(2)){
+      case 0:  // Stored
+        getBits(bitCount & 7);
+        value = getBits(16);
+        if ((getBits(16) ^ 0xFFFF) != value) { failed = true; break; }
+        while (value-- > 0 && !failed){
+          uint8_t b = getBits(8);
+          d->window[outPos++ & (INFLATE_SIZE - 1)] = b;
+          updateCrc(b);
+          putByte(b);
+        }
+        break;
+      case 1:  // Fixed Huffman codes
+        for (int i = 0; i < 288; i++) d->lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        buildHuffman(d->lit, d->lengths, 288);
+        for (int i = 0; i < 30; i++) d->lengths[i] = 5;
+        buildHuffman(d->dist, d->lengths, 30);
+        inflateBlock(d, outPos);
+        break;
+      case 2:  // Dynamic Huffman codes
+        if (readDynamicTrees(d)) inflateBlock(d, outPos);
+        break;
+      default:
+        failed = true;
+    }
+  }while (!last && !failed);
+
+  // Trailer
+  getBits(bitCount & 7);
+  value = getBits(16);
+  value |= getBits(16) << 16;
+  if (value != (crc ^ 0xFFFFFFFF)) failed = true;
+  value = getBits(16);
+  value |= getBits(16) << 16;
+  if (value != outPos) failed = true;
+  flushOutput();
+
+  free(d);
+  return !failed;
+}
+
+// True if the last compress or decompress could not allocate its buffers
+//-----------------------------------------------------
+bool LittleFS_Gzip::outOfMemory(){
+//-----------------------------------------------------
+  return noMemory;
+}
+
+// Checked before every input read, processing stops if it returns true
+//-----------------------------------------------------
+void LittleFS_Gzip::onCancel(std::function<bool()> cancelCheck){
+//-----------------------------------------------------
+  cancel = cancelCheck;
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::begin(Stream &in, Print &out){
+//-----------------------------------------------------
+  input     = &in;
+  output    = &out;
+  inIdx     = 0;
+  inLength  = 0;
+  outIdx    = 0;
+  bitBuffer = 0;
+  bitCount  = 0;
+  crc       = 0xFFFFFFFF;
+  totalSize = 0;
+  failed    = false;
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::updateCrc(uint8_t b){
+//-----------------------------------------------------
+  crc ^= b;
+  crc = (crc >> 4) ^ CRC_TABLE[crc & 15];
+  crc = (crc >> 4) ^ CRC_TABLE[crc & 15];
+}
+
+// Returns -1 at the end of input
+//-----------------------------------------------------
+int LittleFS_Gzip::getByte(){
+//-----------------------------------------------------
+  if (inIdx == inLength){
+    if (cancel && cancel()){
+      failed = true;
+      return -1;
+    }
+    inLength = input->readBytes((char*)inBuffer, IO_SIZE);
+    inIdx    = 0;
+    if (inLength <= 0){
+      inLength = 0;
+      return -1;
+    }
+  }
+  return inBuffer[inIdx++];
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::putByte(uint8_t b){
+//-----------------------------------------------------
+  outBuffer[outIdx++] = b;
+  if (outIdx == IO_SIZE) flushOutput();
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::flushOutput(){
+//-----------------------------------------------------
+  if (outIdx > 0 && output->write(outBuffer, outIdx) != (size_t)outIdx) failed = true;
+  outIdx = 0;
+}
+
+// Deflate bit order, first bit is the least significant bit of the byte
+//-----------------------------------------------------
+void LittleFS_Gzip::putBits(uint32_t value, int count){
+//-----------------------------------------------------
+  bitBuffer |= value << bitCount;
+  bitCount  += count;
+  while (bitCount >= 8){
+    putByte(bitBuffer & 0xFF);
+    bitBuffer >>= 8;
+    bitCount   -= 8;
+  }
+}
+
+// Huffman codes are written from the most significant bit
+//-----------------------------------------------------
+void LittleFS_Gzip::putHuffman(uint16_t code, int length){
+//-----------------------------------------------------
+  uint16_t reversed = 0;
+  for (int i = 0; i < length; i++){
+    reversed = (reversed << 1) | (code & 1);
+    code >>= 1;
+  }
+  putBits(reversed, length);
+}
+
+// Writes the collected symbols as a stored, fixed or dynamic Huffman block, whichever is the shortest.
+// Without data the block is not stored.
+//-----------------------------------------------------
+void LittleFS_Gzip::writeBlock(Deflater *d, const uint8_t *data, int size, bool last){
+//-----------------------------------------------------
+  uint32_t extraBits = 0;
+  uint32_t fixedBits, dynamicBits, storedBits;
+  int      litCount, distCount, codeCount;
+
+  memset(d->litFreq,  0, sizeof(d->litFreq));
+  memset(d->distFreq, 0, sizeof(d->distFreq));
+  for (int i = 0; i < d->symCount; i++){
+    if (d->symDist[i] == 0){
+      d->litFreq[d->symValue[i]]++;
+      continue;
+    }
+    int l = lengthCode(d->symValue[i] + MIN_MATCH);
+    int c = distCode(d->symDist[i]);
+    d->litFreq[257 + l]++;
+    d->distFreq[c]++;
+    extraBits += LENGTH_EXTRA[l] + DIST_EXTRA[c];
+  }
+  d->litFreq[256] = 1;
+
+  // Fixed codes
+  fixedLengths(d);
+  fixedBits = 3 + extraBits;
+  for (int i = 0; i < 286; i++) fixedBits += d->litFreq[i] * d->litLength[i];
+  for (int i = 0; i < 30; i++)  fixedBits += d->distFreq[i] * d->distLength[i];
+
+  // Stored bytes after the byte alignment
+  storedBits = data ? 3 + ((5 - bitCount) & 7) + 32 + 8 * size : 0xFFFFFFFF;
+
+  // Dynamic codes, code lengths are sent run length encoded with their own code
+  buildLengths(d, d->litFreq,  286, 15, d->litLength);
+  buildLengths(d, d->distFreq, 30,  15, d->distLength);
+  for (litCount = 286; litCount > 257 && d->litLength[litCount - 1] == 0; litCount--);
+  for (distCount = 30; distCount > 1 && d->distLength[distCount - 1] == 0; distCount--);
+  encodeLengths(d, litCount, distCount, false);
+  buildLengths(d, d->codeFreq, 19, 7, d->codeLength);
+  for (codeCount = 19; codeCount > 4 && d->codeLength[CODE_ORDER[codeCount - 1]] == 0; codeCount--);
+
+  dynamicBits = 3 + 14 + 3 * codeCount + extraBits;
+  for (int i = 0; i < 19; i++){
+    dynamicBits += d->codeFreq[i] * (d->codeLength[i] + (i < 16 ? 0 : RLE_EXTRA[i - 16]));
+  }
+  for (int i = 0; i < 286; i++) dynamicBits += d->litFreq[i] * d->litLength[i];
+  for (int i = 0; i < 30; i++)  dynamicBits += d->distFreq[i] * d->distLength[i];
+
+  putBits(last, 1);
+  if (storedBits <= fixedBits && storedBits <= dynamicBits){
+    putBits(0, 2);
+    putBits(0, (8 - bitCount) & 7);
+    putBits(size, 16);
+    putBits(size ^ 0xFFFF, 16);
+    for (int i = 0; i < size; i++) putByte(data[i]);
+    return;
+  }
+
+  if (dynamicBits < fixedBits){
+    putBits(2, 2);
+    putBits(litCount - 257, 5);
+    putBits(distCount - 1, 5);
+    putBits(codeCount - 4, 4);
+    for (int i = 0; i < codeCount; i++) putBits(d->codeLength[CODE_ORDER[i]], 3);
+    makeCodes(d->codeLength, d->codeCode, 19);
+    encodeLengths(d, litCount, distCount, true);
+    makeCodes(d->litLength, d->litCode, 286);
+  }else{
+    putBits(1, 2);
+    fixedLengths(d);
+    makeCodes(d->litLength, d->litCode, 288);  // Unused 286, 287 shift the 9 bit codes
+  }
+  makeCodes(d->distLength, d->distCode, 30);
+  for (int i = 0; i < d->symCount; i++){
+    int value = d->symValue[i];
+    if (d->symDist[i] == 0){
+      putHuffman(d->litCode[value], d->litLength[value]);
+      continue;
+    }
+    int l = lengthCode(value + MIN_MATCH);
+    int c = distCode(d->symDist[i]);
+    putHuffman(d->litCode[257 + l], d->litLength[257 + l]);
+    putBits(value + MIN_MATCH - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+    putHuffman(d->distCode[c], d->distLength[c]);
+    putBits(d->symDist[i] - DIST_BASE[c], DIST_EXTRA[c]);
+  }
+  putHuffman(d->litCode[256], d->litLength[256]);  // End of block
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::fixedLengths(Deflater *d){
+//-----------------------------------------------------
+  for (int i = 0; i < 288; i++) d->litLength[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+  for (int i = 0; i < 30; i++)  d->distLength[i] = 5;
+}
+
+//-----------------------------------------------------
+int LittleFS_Gzip::lengthCode(int length){
+//-----------------------------------------------------
+  int i = 28;
+  while (LENGTH_BASE[i] > length) i--;
+  return i;
+}
+
+//-----------------------------------------------------
+int LittleFS_Gzip::distCode(int distance){
+//-----------------------------------------------------
+  int i = 29;
+  while (DIST_BASE[i] > distance) i--;
+  return i;
+}
+
+// Code lengths limited to maxLength. The symbols are sorted by weight, and the weights
+// are halved until the longest code fits. A tree gets at least two codes.
+//-----------------------------------------------------
+void LittleFS_Gzip::buildLengths(Deflater *d, uint16_t *freq, int count, int maxLength, uint8_t *lengths){
+//-----------------------------------------------------
+  int used = 0;
+
+  for (int i = 0; i < count; i++) if (freq[i] != 0) used++;
+  for (int i = 0; i < count && used < 2; i++){
+    if (freq[i] == 0){
+      freq[i] = 1;
+      used++;
+    }
+  }
+
+  for (int shift = 0; ; shift++){
+    int n = 0;
+    for (int i = 0; i < count; i++){
+      lengths[i] = 0;
+      if (freq[i] == 0) continue;
+      uint16_t w = shift == 0 ? freq[i] : (freq[i] >> shift) | 1;
+      int j = n++;
+      while (j > 0 && d->weight[j - 1] > w){
+        d->weight[j] = d->weight[j - 1];
+        d->sorted[j] = d->sorted[j - 1];
+        j--;
+      }
+      d->weight[j] = w;
+      d->sorted[j] = i;
+    }
+    huffmanLengths(d->weight, n);
+    if (d->weight[0] <= maxLength){
+      for (int i = 0; i < n; i++) lengths[d->sorted[i]] = d->weight[i];
+      return;
+    }
+  }
+}
+
+// Minimum redundancy code lengths in place (Moffat, Katajainen) from ascending weights,
+// the first one gets the longest code
+//-----------------------------------------------------
+void LittleFS_Gzip::huffmanLengths(uint16_t *a, int n){
+//-----------------------------------------------------
+  int root, leaf, next, avail, used, depth;
+
+  // Parent pointers, left to right
+  a[0] += a[1];
+  root = 0;
+  leaf = 2;
+  for (next = 1; next < n - 1; next++){
+    if (leaf >= n || a[root] < a[leaf]){
+      a[next] = a[root];
+      a[root++] = next;
+    }else{
+      a[next] = a[leaf++];
+    }
+    if (leaf >= n || (root < next && a[root] < a[leaf])){
+      a[next] += a[root];
+      a[root++] = next;
+    }else{
+      a[next] += a[leaf++];
+    }
+  }
+
+  // Internal node depths, right to left
+  a[n - 2] = 0;
+  for (next = n - 3; next >= 0; next--) a[next] = a[a[next]] + 1;
+
+  // Leaf depths, right to left
+  avail = 1;
+  used  = 0;
+  depth = 0;
+  root  = n - 2;
+  next  = n - 1;
+  while (avail > 0){
+    while (root >= 0 && a[root] == depth){
+      used++;
+      root--;
+    }
+    while (avail > used){
+      a[next--] = depth;
+      avail--;
+    }
+    avail = 2 * used;
+    depth++;
+    used  = 0;
+  }
+}
+
+// Canonical Huffman codes from code lengths
+//-----------------------------------------------------
+void LittleFS_Gzip::makeCodes(const uint8_t *lengths, uint16_t *codes, int count){
+//-----------------------------------------------------
+  uint16_t lengthCount[16] = {0};
+  uint16_t next[16];
+  uint16_t code = 0;
+
+  for (int i = 0; i < count; i++) lengthCount[lengths[i]]++;
+  lengthCount[0] = 0;
+  for (int i = 1; i < 16; i++){
+    code    = (code + lengthCount[i - 1]) << 1;
+    next[i] = code;
+  }
+  for (int i = 0; i < count; i++){
+    if (lengths[i] != 0) codes[i] = next[lengths[i]]++;
+  }
+}
+
+// Literal and distance code lengths as one sequence of code length symbols,
+// 16 repeats the previous length, 17 and 18 repeat zero. First the symbols are
+// counted, then with write they are written with their codes.
+//-----------------------------------------------------
+void LittleFS_Gzip::encodeLengths(Deflater *d, int litCount, int distCount, bool write){
+//-----------------------------------------------------
+  int total = litCount + distCount;
+  auto lengthAt = [&](int i){ return i < litCount ? d->litLength[i] : d->distLength[i - litCount]; };
+  auto add = [&](uint8_t symbol, uint8_t extra){
+    if (!write){
+      d->codeFreq[symbol]++;
+      return;
+    }
+    putHuffman(d->codeCode[symbol], d->codeLength[symbol]);
+    if (symbol >= 16) putBits(extra, RLE_EXTRA[symbol - 16]);
+  };
+
+  if (!write) memset(d->codeFreq, 0, sizeof(d->codeFreq));
+  for (int i = 0; i < total; ){
+    uint8_t value = lengthAt(i);
+    int     run   = 1;
+    while (i + run < total && lengthAt(i + run) == value) run++;
+
+    if (value == 0 && run >= 3){
+      if (run > 138) run = 138;
+      if (run >= 11) add(18, run - 11);
+      else           add(17, run - 3);
+    }else if (value != 0 && run >= 4){
+      if (run > 7) run = 7;
+      add(value, 0);
+      add(16, run - 4);
+    }else{
+      run = 1;
+      add(value, 0);
+    }
+    i += run;
+  }
+}
+
+// Drops the older half of the buffer, hash chains pointing there are cut
+//-----------------------------------------------------
+void LittleFS_Gzip::slideWindow(Deflater *d){
+//-----------------------------------------------------
+  memcpy(d->window, d->window + WINDOW_SIZE, WINDOW_SIZE);
+  for (int i = 0; i < HASH_SIZE; i++){
+    d->head[i] = d->head[i] != NIL && d->head[i] >= WINDOW_SIZE ? d->head[i] - WINDOW_SIZE : NIL;
+  }
+  for (int i = 0; i < WINDOW_SIZE; i++){
+    d->prev[i] = d->prev[i] != NIL && d->prev[i] >= WINDOW_SIZE ? d->prev[i] - WINDOW_SIZE : NIL;
+  }
+}
+
+// Reads count bits (max 16). At the end of input sets failed and gives zero bits.
+//-----------------------------------------------------
+uint32_t LittleFS_Gzip::getBits(int count){
+//-----------------------------------------------------
+  uint32_t value;
+
+  while (bitCount < count){
+    int b = getByte();
+    if (b < 0){
+      failed = true;
+      b = 0;
+    }
+    bitBuffer |= (uint32_t)b << bitCount;
+    bitCount  += 8;
+  }
+  value = bitBuffer & ((1UL << count) - 1);
+  bitBuffer >>= count;
+  bitCount   -= count;
+  return value;
+}
+
+// Canonical Huffman code from code lengths
+//-----------------------------------------------------
+void LittleFS_Gzip::buildHuffman(Huffman &h, const uint8_t *lengths, int count){
+//-----------------------------------------------------
+  uint16_t offsets[16];
+
+  for (int i = 0; i < 16; i++) h.counts[i] = 0;
+  for (int i = 0; i < count; i++) h.counts[lengths[i]]++;
+  h.counts[0] = 0;
+
+  offsets[1] = 0;
+  for (int i = 1; i < 15; i++) offsets[i + 1] = offsets[i] + h.counts[i];
+  for (int i = 0; i < count; i++){
+    if (lengths[i] != 0) h.symbols[offsets[lengths[i]]++] = i;
+  }
+}
+
+// Reads the code bit by bit, codes of a length are consecutive numbers
+//-----------------------------------------------------
+int LittleFS_Gzip::decodeSymbol(const Huffman &h){
+//-----------------------------------------------------
+  int code  = 0;
+  int first = 0;
+  int index = 0;
+
+  for (int length = 1; length < 16 && !failed; length++){
+    code |= getBits(1);
+    if (code - first < h.counts[length]){
+      return h.symbols[index + code - first];
+    }
+    index += h.counts[length];
+    first  = (first + h.counts[length]) << 1;
+    code <<= 1;
+  }
+  failed = true;
+  return -1;
+}
+
+//-----------------------------------------------------
+bool LittleFS_Gzip::readDynamicTrees(Inflater *d){
+//-----------------------------------------------------
+  int litCount  = getBits(5) + 257;
+  int distCount = getBits(5) + 1;
+  int codeCount = getBits(4) + 4;
+  int idx = 0;
+
+  if (litCount > 286 || distCount > 30){
+    failed = true;
+    return false;
+  }
+
+  // Code length codes, the lit tree is used for them temporarily
+  for (int i = 0; i < 19; i++) d->lengths[i] = 0;
+  for (int i = 0; i < codeCount; i++) d->lengths[CODE_ORDER[i]] = getBits(3);
+  buildHuffman(d->lit, d->lengths, 19);
+
+  while (idx < litCount + distCount && !failed){
+    int symbol = decodeSymbol(d->lit);
+    int repeat;
+    uint8_t value = 0;
+
+    if (symbol < 0) break;
+    if (symbol < 16){
+      d->lengths[idx++] = symbol;
+      continue;
+    }
+    if (symbol == 16){
+      if (idx == 0) { failed = true; break; }
+      value  = d->lengths[idx - 1];
+      repeat = 3 + getBits(2);
+    }else if (symbol == 17){
+      repeat = 3 + getBits(3);
+    }else{
+      repeat = 11 + getBits(7);
+    }
+    if (idx + repeat > litCount + distCount) { failed = true; break; }
+    while (repeat-- > 0) d->lengths[idx++] = value;
+  }
+  if (failed) return false;
+
+  buildHuffman(d->lit,  d->lengths,            litCount);
+  buildHuffman(d->dist, d->lengths + litCount, distCount);
+  return true;
+}
+
+//-----------------------------------------------------
+void LittleFS_Gzip::inflateBlock(Inflater *d, uint32_t &outPos){
+//-----------------------------------------------------
+  while (!failed){
+    int symbol = decodeSymbol(d->lit);
+
+    if (symbol < 0 || symbol == 256) return;
+    if (symbol < 256){
+      d->window[outPos++ & (INFLATE_SIZE - 1)] = symbol;
+      updateCrc(symbol);
+      putByte(symbol);
+      continue;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29) { failed = true; return; }
+    int length = LENGTH_BASE[symbol] + getBits(LENGTH_EXTRA[symbol]);
+
+    symbol = decodeSymbol(d->dist);
+    if (symbol < 0 || symbol >= 30) { failed = true; return; }
+    uint32_t distance = DIST_BASE[symbol] + getBits(DIST_EXTRA[symbol]);
+
+    // Farther than the window
+    if (distance > INFLATE_SIZE || distance > outPos) { failed = true; return; }
+
+    while (length-- > 0){
+      uint8_t b = d->window[(outPos - distance) & (INFLATE_SIZE - 1)];
+      d->window[outPos++ & (INFLATE_SIZE - 1)] = b;
+      updateCrc(b);
+      putByte(b);
+    }
+  }
+}
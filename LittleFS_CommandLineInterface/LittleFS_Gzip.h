@@ -0,0 +1,112 @@
+/*
+  LittleFS_Gzip.h - Streaming gzip compression for LittleFS command line interface.
+  Released into the public domain.
+
+  Deflate with a small window, stored, fixed or dynamic Huffman blocks. Inflate of any
+  deflate stream whose back references fit into the inflate window. Memory is allocated only while
+  a stream is processed.
+*/
+
+#ifndef LittleFS_Gzip_h
+#define LittleFS_Gzip_h
+
+#include <Arduino.h>
+#include <functional>
+
+/*------------------------------------------------------------*/
+class LittleFS_Gzip{
+/*------------------------------------------------------------*/
+
+    const static int WINDOW_SIZE  = 1024;  // Compression window, must be power of two
+    const static int BUFFER_SIZE  = 2 * WINDOW_SIZE;  // Input buffer, the window and the bytes ahead
+    const static int SYMBOL_COUNT = 512;   // Max literals and matches in a block
+    const static int INFLATE_SIZE = 4096;  // Decompression window, must be power of two
+    const static int HASH_SIZE    = 512;   // Must be power of two
+    const static int MAX_CHAIN    = 16;    // Match candidates checked at a position
+    const static int MIN_MATCH    = 3;
+    const static int MAX_MATCH    = 258;
+    const static int IO_SIZE      = 64;
+    const static uint16_t NIL     = 0xFFFF;
+
+    struct Huffman{
+      uint16_t counts[16];
+      uint16_t symbols[288];
+    };
+
+    struct Deflater{
+      uint8_t  window[BUFFER_SIZE];
+      uint16_t head[HASH_SIZE];
+      uint16_t prev[WINDOW_SIZE];
+      uint8_t  symValue[SYMBOL_COUNT];   // Literal, or match length - MIN_MATCH
+      uint16_t symDist[SYMBOL_COUNT];    // Zero for literals
+      int      symCount;
+      uint16_t litFreq[286];
+      uint16_t distFreq[30];
+      uint16_t codeFreq[19];
+      uint8_t  litLength[288];
+      uint8_t  distLength[30];
+      uint8_t  codeLength[19];
+      union{                             // Sorting space of the code lengths, then the codes
+        struct{
+          uint16_t sorted[286];
+          uint16_t weight[286];
+        };
+        struct{
+          uint16_t litCode[288];
+          uint16_t distCode[30];
+          uint16_t codeCode[19];
+        };
+      };
+    };
+
+    struct Inflater{
+      uint8_t  window[INFLATE_SIZE];
+      uint8_t  lengths[320];
+      Huffman  lit;
+      Huffman  dist;
+    };
+
+    Stream   *input;
+    Print    *output;
+    uint8_t   inBuffer[IO_SIZE];
+    uint8_t   outBuffer[IO_SIZE];
+    int       inIdx, inLength, outIdx;
+    uint32_t  bitBuffer;
+    int       bitCount;
+    uint32_t  crc;
+    uint32_t  totalSize;
+    bool      failed;
+    bool      noMemory = false;
+    std::function<bool()> cancel;
+
+  public:
+    bool     compress(Stream &in, Print &out);
+    bool     decompress(Stream &in, Print &out);
+    void     onCancel(std::function<bool()> cancelCheck);
+    bool     outOfMemory();
+
+  private:
+    void     begin(Stream &in, Print &out);
+    void     updateCrc(uint8_t b);
+    int      getByte();
+    void     putByte(uint8_t b);
+    void     flushOutput();
+    void     putBits(uint32_t value, int count);
+    void     putHuffman(uint16_t code, int length);
+    void     writeBlock(Deflater *d, const uint8_t *data, int size, bool last);
+    void     fixedLengths(Deflater *d);
+    int      lengthCode(int length);
+    int      distCode(int distance);
+    void     buildLengths(Deflater *d, uint16_t *freq, int count, int maxLength, uint8_t *lengths);
+    void     huffmanLengths(uint16_t *a, int n);
+    void     makeCodes(const uint8_t *lengths, uint16_t *codes, int count);
+    void     encodeLengths(Deflater *d, int litCount, int distCount, bool write);
+    void     slideWindow(Deflater *d);
+    uint32_t getBits(int count);
+    void     buildHuffman(Huffman &h, const uint8_t *lengths, int count);
+    int      decodeSymbol(const Huffman &h);
+    bool     readDynamicTrees(Inflater *d);
+    void     inflateBlock(Inflater *d, uint32_t &outPos);
+};
+
+#endif
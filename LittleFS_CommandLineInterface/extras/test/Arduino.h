@@ -0,0 +1,153 @@
+/*
+  Arduino.h - Host stub of the Arduino core for the library tests.
+  Released into the public domain.
+
+  Only the parts used by the library are here. Serial input is fed by the tests,
+  the output is collected into a string.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+using std::min;
+using std::max;
+
+#define HEX 16
+
+/*------------------------------------------------------------*/
+class String : public std::string{
+/*------------------------------------------------------------*/
+  public:
+    String() {}
+    String(const char *s)        : std::string(s) {}
+    String(const std::string &s) : std::string(s) {}
+    String(char c)               : std::string(1, c) {}
+    String(int v)                : std::string(std::to_string(v)) {}
+    String(unsigned v)           : std::string(std::to_string(v)) {}
+    String(long v)               : std::string(std::to_string(v)) {}
+    String(unsigned long v)      : std::string(std::to_string(v)) {}
+    String(long long v)          : std::string(std::to_string(v)) {}
+    String(unsigned long long v) : std::string(std::to_string(v)) {}
+
+    unsigned int length() const { return size(); }
+    String substring(unsigned from) const { return from >= size() ? String() : String(substr(from)); }
+    String substring(unsigned from, unsigned to) const{
+      if (from > to) std::swap(from, to);
+      return from >= size() ? String() : String(substr(from, to - from));
+    }
+    int  indexOf(char c) const                { size_t p = find(c);       return p == npos ? -1 : p; }
+    int  indexOf(char c, unsigned from) const { size_t p = find(c, from); return p == npos ? -1 : p; }
+    int  indexOf(const String &s) const       { size_t p = find(s);       return p == npos ? -1 : p; }
+    int  lastIndexOf(char c) const            { size_t p = rfind(c);      return p == npos ? -1 : p; }
+    bool startsWith(const String &s) const    { return compare(0, s.size(), s) == 0; }
+    bool endsWith(const String &s) const      { return size() >= s.size() && compare(size() - s.size(), s.size(), s) == 0; }
+    char charAt(unsigned i) const             { return i < size() ? (*this)[i] : 0; }
+    long toInt() const                        { return atol(c_str()); }
+    bool reserve(unsigned n)                  { std::string::reserve(n); return true; }
+    void remove(int i)                        { if (i >= 0 && (size_t)i < size()) erase(i); }
+    void remove(int i, int n)                 { if (i >= 0 && (size_t)i < size()) erase(i, n); }
+    void replace(const String &from, const String &to){
+      for (size_t p = 0; !from.empty() && (p = find(from, p)) != npos; p += to.size()) std::string::replace(p, from.size(), to);
+    }
+    void trim(){
+      size_t b = find_first_not_of(" \t\r\n");
+      *this = b == npos ? String() : String(substr(b, find_last_not_of(" \t\r\n") - b + 1));
+    }
+    String &operator+=(const String &s) { append(s);    return *this; }
+    String &operator+=(const char *s)   { append(s);    return *this; }
+    String &operator+=(char c)          { push_back(c); return *this; }
+};
+
+inline String operator+(const String &a, const String &b) { return String(std::string(a) + std::string(b)); }
+inline String operator+(const String &a, const char *b)   { return String(std::string(a) + b); }
+inline String operator+(const char *a, const String &b)   { return String(a + std::string(b)); }
+inline String operator+(const String &a, char b)          { return String(std::string(a) + b); }
+inline String operator+(char a, const String &b)          { return String(std::string(1, a) + std::string(b)); }
+
+/*------------------------------------------------------------*/
+class Print{
+/*------------------------------------------------------------*/
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size){
+      size_t i = 0;
+      while (i < size && write(buffer[i])) i++;
+      return i;
+    }
+    size_t write(const char *s)              { return write((const uint8_t*)s, strlen(s)); }
+    size_t write(const char *s, size_t size) { return write((const uint8_t*)s, size); }
+
+    size_t print(const String &s) { return write((const uint8_t*)s.data(), s.size()); }
+    size_t print(const char *s)   { return write(s); }
+    size_t print(char c)          { return write((uint8_t)c); }
+    size_t print(int v, int base = 10){
+      char b[16];
+      snprintf(b, sizeof(b), base == HEX ? "%X" : "%d", v);
+      return print(b);
+    }
+    size_t print(unsigned v)           { return print(String(v)); }
+    size_t print(long v)               { return print(String(v)); }
+    size_t print(unsigned long v)      { return print(String(v)); }
+    size_t print(long long v)          { return print(String(v)); }
+    size_t print(unsigned long long v) { return print(String(v)); }
+    template <class T> size_t println(const T &v) { return print(v) + println(); }
+    size_t println() { return print("\r\n"); }
+};
+
+/*------------------------------------------------------------*/
+class Stream : public Print{
+/*------------------------------------------------------------*/
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(char *buffer, size_t length){
+      size_t i = 0;
+      for (int c; i < length && (c = read()) >= 0; i++) buffer[i] = c;
+      return i;
+    }
+    String readStringUntil(char terminator){
+      String s;
+      for (int c; (c = read()) >= 0 && c != terminator; ) s += (char)c;
+      return s;
+    }
+};
+
+/*------------------------------------------------------------*/
+class HostSerial : public Stream{
+/*------------------------------------------------------------*/
+  public:
+    std::deque<uint8_t> input;
+    std::string         output;
+
+    int    available() override { return input.size(); }
+    int    peek() override      { return input.empty() ? -1 : input.front(); }
+    int    read() override{
+      if (input.empty()) return -1;
+      int c = input.front();
+      input.pop_front();
+      return c;
+    }
+    size_t write(uint8_t c) override { output.push_back(c); return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { output.append((const char*)buffer, size); return size; }
+    using Print::write;
+    void   feed(const std::string &s) { input.insert(input.end(), s.begin(), s.end()); }
+};
+
+extern HostSerial Serial;
+
+unsigned long millis();
+void yield();
+void delay(unsigned long ms);
+
+#endif
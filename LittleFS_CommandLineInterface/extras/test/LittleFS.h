@@ -0,0 +1,169 @@
+/*
+  LittleFS.h - Host stub of the ESP8266 LittleFS for the library tests.
+  Released into the public domain.
+
+  Files are kept in the hostRoot directory of the host file system.
+*/
+
+#ifndef LittleFS_h
+#define LittleFS_h
+
+#include "Arduino.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace hostfs = std::filesystem;
+
+extern std::string hostRoot;
+
+enum SeekMode { SeekSet = SEEK_SET, SeekCur = SEEK_CUR, SeekEnd = SEEK_END };
+
+struct FSInfo64{
+  uint64_t totalBytes    = 1 << 20;
+  uint64_t usedBytes     = 0;
+  size_t   blockSize     = 8192;
+  size_t   pageSize      = 256;
+  size_t   maxOpenFiles  = 5;
+  size_t   maxPathLength = 32;
+};
+
+inline std::string hostPath(const String &path) { return hostRoot + std::string(path); }
+
+// Modification time in seconds, only the order matters for the tests
+inline time_t hostTime(const std::string &real){
+  std::error_code ec;
+  auto t = hostfs::last_write_time(real, ec);
+  return ec ? 0 : std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+/*------------------------------------------------------------*/
+class File : public Stream{
+/*------------------------------------------------------------*/
+    std::shared_ptr<FILE> file;
+    bool        directory = false;
+    bool        valid     = false;
+    std::string path;
+
+  public:
+    File() {}
+    File(const String &p, const char *mode) : path(p){
+      std::string real = hostPath(p);
+      std::string m    = mode;
+      if (hostfs::is_directory(real)){
+        directory = valid = true;
+        return;
+      }
+      // LittleFS creates the missing directories of a written file
+      if (m[0] == 'w' || m[0] == 'a') hostfs::create_directories(hostfs::path(real).parent_path());
+      FILE *f = fopen(real.c_str(), (m + "b").c_str());
+      if (!f) return;
+      file.reset(f, fclose);
+      valid = true;
+    }
+
+    explicit operator bool() const { return valid; }
+    bool   isDirectory() const { return valid && directory; }
+    bool   isFile() const      { return valid && !directory; }
+    size_t size(){
+      if (!file) return 0;
+      long pos = ftell(file.get());
+      fseek(file.get(), 0, SEEK_END);
+      long end = ftell(file.get());
+      fseek(file.get(), pos, SEEK_SET);
+      return end;
+    }
+    size_t position()                      { return file ? ftell(file.get()) : 0; }
+    bool   seek(uint32_t pos, SeekMode mode) { return file && fseek(file.get(), pos, mode) == 0; }
+    bool   seek(uint32_t pos)              { return seek(pos, SeekSet); }
+    int    available() override            { return file ? size() - position() : 0; }
+    int    read() override                 { return file ? fgetc(file.get()) : -1; }
+    int    peek() override{
+      int c = read();
+      if (c >= 0) ungetc(c, file.get());
+      return c;
+    }
+    size_t read(uint8_t *buffer, size_t size)               { return file ? fread(buffer, 1, size, file.get()) : 0; }
+    size_t readBytes(char *buffer, size_t length) override  { return read((uint8_t*)buffer, length); }
+    size_t write(uint8_t c) override                        { return file && fputc(c, file.get()) != EOF; }
+    size_t write(const uint8_t *buffer, size_t size) override { return file ? fwrite(buffer, 1, size, file.get()) : 0; }
+    using Print::write;
+    void   flush()                         { if (file) fflush(file.get()); }
+    void   close()                         { file.reset(); valid = false; }
+    time_t getLastWrite()                  { return hostTime(hostPath(path)); }
+    const char *name()                     { return path.c_str(); }
+};
+
+/*------------------------------------------------------------*/
+class Dir{
+/*------------------------------------------------------------*/
+    std::vector<hostfs::directory_entry> entries;
+    int    idx = -1;
+    String base;
+
+  public:
+    Dir() {}
+    Dir(const String &path) : base(path){
+      std::error_code ec;
+      if (hostfs::is_directory(hostPath(path))){
+        for (auto &entry : hostfs::directory_iterator(hostPath(path), ec)) entries.push_back(entry);
+      }
+    }
+    bool   next()        { return ++idx < (int)entries.size(); }
+    String fileName()    { return entries[idx].path().filename().string(); }
+    bool   isFile()      { return entries[idx].is_regular_file(); }
+    bool   isDirectory() { return entries[idx].is_directory(); }
+    size_t fileSize()    { return isFile() ? entries[idx].file_size() : 0; }
+    time_t fileTime()    { return hostTime(entries[idx].path().string()); }
+    File   openFile(const char *mode) { return File(base + "/" + fileName(), mode); }
+};
+
+/*------------------------------------------------------------*/
+class LittleFSClass{
+/*------------------------------------------------------------*/
+    // LittleFS has no empty directories after the last file is removed
+    void prune(hostfs::path p){
+      while (p.string().size() > hostRoot.size() + 1 && hostfs::is_directory(p) && hostfs::is_empty(p)){
+        hostfs::remove(p);
+        p = p.parent_path();
+      }
+    }
+
+  public:
+    bool begin()  { hostfs::create_directories(hostRoot); return true; }
+    void end()    {}
+    bool format() { hostfs::remove_all(hostRoot); return begin(); }
+    bool info64(FSInfo64 &info) { info = FSInfo64(); return true; }
+    bool exists(const String &path)                 { return hostfs::exists(hostPath(path)); }
+    File open(const String &path, const char *mode) { return File(path, mode); }
+    Dir  openDir(const String &path)                { return Dir(path); }
+    bool mkdir(const String &path){
+      std::error_code ec;
+      return hostfs::create_directory(hostPath(path), ec);
+    }
+    bool rmdir(const String &path){
+      std::error_code ec;
+      if (!hostfs::is_directory(hostPath(path)) || !hostfs::is_empty(hostPath(path))) return false;
+      hostfs::remove(hostPath(path), ec);
+      prune(hostfs::path(hostPath(path)).parent_path());
+      return !ec;
+    }
+    bool remove(const String &path){
+      std::error_code ec;
+      if (!hostfs::is_regular_file(hostPath(path))) return false;
+      hostfs::remove(hostPath(path), ec);
+      prune(hostfs::path(hostPath(path)).parent_path());
+      return !ec;
+    }
+    // Like LittleFS, the target directory must exist
+    bool rename(const String &from, const String &to){
+      std::error_code ec;
+      hostfs::rename(hostPath(from), hostPath(to), ec);
+      if (!ec) prune(hostfs::path(hostPath(from)).parent_path());
+      return !ec;
+    }
+};
+
+extern LittleFSClass LittleFS;
+
+#endif
@@ -0,0 +1,2 @@
+// String is declared by the Arduino.h stub
+#include "Arduino.h"
@@ -0,0 +1,29 @@
+/*
+  host.cpp - Arduino core functions for the library tests.
+  Released into the public domain.
+*/
+
+#include "Arduino.h"
+#include "LittleFS.h"
+#include <chrono>
+
+HostSerial    Serial;
+LittleFSClass LittleFS;
+std::string   hostRoot = "fsroot";
+
+//-----------------------------------------------------
+unsigned long millis(){
+//-----------------------------------------------------
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------
+void yield(){
+//-----------------------------------------------------
+}
+
+//-----------------------------------------------------
+void delay(unsigned long ms){
+//-----------------------------------------------------
+}
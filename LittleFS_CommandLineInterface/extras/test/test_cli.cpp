@@ -0,0 +1,231 @@
+/*
+  test_cli.cpp - Command tests of LittleFS_CommandLineInterface on the host file system stub.
+  Released into the public domain.
+*/
+
+#include "LittleFS_CommandLineInterface.h"
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+static int failures = 0;
+
+#define CHECK(condition, name) \
+  if (!(condition)) { printf("FAILED: %s: %s\n", name, #condition); failures++; }
+
+//-----------------------------------------------------
+static std::string run(LittleFS_CommandLineInterface &cli, const std::string &command, const std::string &input = ""){
+//-----------------------------------------------------
+  Serial.output.clear();
+  Serial.feed(command + "\r\n" + input);
+  cli.readCommandLine();
+  return Serial.output;
+}
+
+//-----------------------------------------------------
+static std::string content(const std::string &path){
+//-----------------------------------------------------
+  std::ifstream     f(hostRoot + path, std::ios::binary);
+  std::stringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
+
+//-----------------------------------------------------
+static std::multiset<std::string> indexLines(){
+//-----------------------------------------------------
+  std::multiset<std::string> lines;
+  std::stringstream s(content(INDEX_FILE));
+  for (std::string line; std::getline(s, line); ) lines.insert(line);
+  return lines;
+}
+
+// Index kept up to date by the commands equals a freshly built one
+//-----------------------------------------------------
+static void checkIndex(LittleFS_CommandLineInterface &cli, const char *name){
+//-----------------------------------------------------
+  std::multiset<std::string> updated = indexLines();
+  run(cli, "find -index on");
+  CHECK(updated == indexLines(), name);
+}
+
+//-----------------------------------------------------
+static void testIndex(LittleFS_CommandLineInterface &cli){
+//-----------------------------------------------------
+  run(cli, "format", "Y");
+  run(cli, "load /a.txt", "first");
+  run(cli, "load /b.txt", "second file");
+  run(cli, "find -index on");
+
+  // Renamed onto an existing file, its old line is dropped
+  run(cli, "ren /a.txt /b.txt");
+  CHECK(indexLines().count("/b.txt\t5") == 1, "ren onto file");
+  CHECK(indexLines().size() == 1, "ren onto file");
+  checkIndex(cli, "ren onto file");
+
+  // More files than one index batch
+  for (int i = 0; i < 20; i++) run(cli, "load /s/f" + std::to_string(i), std::string(i + 1, 'x'));
+  run(cli, "mkdir /d");
+  run(cli, "copy /s/* /d");
+  checkIndex(cli, "copy *");
+  run(cli, "ren /d /e");
+  checkIndex(cli, "ren dir");
+  run(cli, "gzip /e/f3");
+  checkIndex(cli, "gzip");
+  run(cli, "del /s/*");
+  checkIndex(cli, "del *");
+  CHECK(indexLines().size() == 21, "del *");
+  CHECK(run(cli, "find -name f1?").find("10 files found") != std::string::npos, "find in index");
+
+  // Index and temporary files stay out of the directory commands
+  std::ofstream(hostRoot + TEMP_FILE) << "partial";
+  CHECK(run(cli, "dir").find("~") == std::string::npos, "dir hides reserved");
+  CHECK(run(cli, "tree").find("~") == std::string::npos, "tree hides reserved");
+  LittleFS.remove(TEMP_FILE);
+  run(cli, "del /*");
+  CHECK(LittleFS.exists(INDEX_FILE), "del * skips index");
+  run(cli, "load /c.txt", "third");
+  run(cli, "mkdir /g");
+  run(cli, "copy /* /g");
+  CHECK(LittleFS.exists("/g/c.txt") && !LittleFS.exists("/g/~index"), "copy * skips reserved");
+  checkIndex(cli, "reserved");
+
+  // Reserved names are not written by commands
+  std::string index = content(INDEX_FILE);
+  CHECK(run(cli, "load /~index", "junk").find("reserved") != std::string::npos, "load reserved");
+  Serial.input.clear();
+  CHECK(run(cli, "patch /~index 0", "junk").find("reserved") != std::string::npos, "patch reserved");
+  Serial.input.clear();
+  CHECK(run(cli, "ren /c.txt /~index").find("reserved") != std::string::npos, "ren reserved");
+  CHECK(run(cli, "copy /c.txt /~index").find("reserved") != std::string::npos, "copy reserved");
+  CHECK(content(INDEX_FILE) == index && LittleFS.exists("/c.txt"), "reserved unchanged");
+
+  run(cli, "find -index off");
+  CHECK(!LittleFS.exists(INDEX_FILE), "index off");
+
+  // Without index the temporary file is not touched by del
+  std::ofstream(hostRoot + TEMP_FILE) << "partial";
+  run(cli, "del /*");
+  CHECK(LittleFS.exists(TEMP_FILE), "del * skips temp");
+}
+
+// Names in the order dir lists them
+//-----------------------------------------------------
+static std::vector<std::string> listed(LittleFS_CommandLineInterface &cli, const std::string &command){
+//-----------------------------------------------------
+  std::vector<std::string> names;
+  std::stringstream s(run(cli, command));
+  std::string       line;
+  std::getline(s, line);  // Command line echo
+  while (std::getline(s, line) && line.find_first_not_of(" \r") != std::string::npos){
+    names.push_back(line.substr(0, line.find(' ')));
+  }
+  return names;
+}
+
+// More entries than one sorting page, sizes with equals, times all different
+//-----------------------------------------------------
+static void testDirSort(LittleFS_CommandLineInterface &cli){
+//-----------------------------------------------------
+  struct Entry { std::string name; size_t size; time_t time; };
+  std::vector<Entry> entries;
+  const int count = 300;
+
+  run(cli, "format", "Y");
+  hostfs::create_directories(hostRoot + "/p");
+  for (int i = 0; i < count; i++){
+    int         shuffled = (i * 7919) % count;
+    std::string name     = "f" + std::to_string(1000 + shuffled);
+    std::ofstream(hostRoot + "/p/" + name) << std::string(shuffled % 37, 'x');
+    hostfs::last_write_time(hostRoot + "/p/" + name, hostfs::file_time_type::clock::now() - std::chrono::hours(i));
+    entries.push_back({name, (size_t)(shuffled % 37), hostTime(hostRoot + "/p/" + name)});
+  }
+
+  auto check = [&](const char *option, auto before){
+    std::vector<std::string> expected;
+    std::sort(entries.begin(), entries.end(), [&](const Entry &a, const Entry &b){
+      return before(a, b) || (!before(b, a) && a.name < b.name);
+    });
+    for (Entry &e : entries) expected.push_back(e.name);
+    CHECK(listed(cli, std::string("dir /p ") + option) == expected, option);
+  };
+  check("-n", [](const Entry &a, const Entry &b){ return false; });
+  check("-s", [](const Entry &a, const Entry &b){ return a.size > b.size; });
+  check("-t", [](const Entry &a, const Entry &b){ return a.time > b.time; });
+  CHECK(listed(cli, "dir /p").size() == count, "unsorted");
+}
+
+// Line end modes and the offset, length slice
+//-----------------------------------------------------
+static void testType(LittleFS_CommandLineInterface &cli){
+//-----------------------------------------------------
+  std::string out;
+
+  run(cli, "format", "Y");
+  std::ofstream(hostRoot + "/t.txt", std::ios::binary) << "ab\ncd\r\nef\n\rgh";
+
+  out = run(cli, "type /t.txt -raw");
+  CHECK(out.find("ab\ncd\r\nef\n\rgh") != std::string::npos, "type -raw");
+  out = run(cli, "type /t.txt -lf");
+  CHECK(out.find("ab\ncd\nef\ngh") != std::string::npos, "type -lf");
+  out = run(cli, "type /t.txt");
+  CHECK(out.find("ab\r\ncd\r\nef\r\ngh") != std::string::npos, "type -crlf");
+  out = run(cli, "type /t.txt -raw -o 3 -n 4");
+  CHECK(out.find("cd\r\n") != std::string::npos && out.find("ef") == std::string::npos, "type slice");
+  out = run(cli, "type /t.txt -raw -o 11");
+  CHECK(out.find("gh") != std::string::npos && out.find("\rgh") == std::string::npos, "type offset");
+  out = run(cli, "type /t.txt hex -o 5 -n 2");
+  CHECK(out.find("5 | 0D 0A ") != std::string::npos && out.find("64") == std::string::npos, "type hex slice");
+}
+
+// CTRL+C typed behind other characters stops the command, no partial file remains
+//-----------------------------------------------------
+static void testCancel(LittleFS_CommandLineInterface &cli){
+//-----------------------------------------------------
+  std::string big;
+
+  run(cli, "format", "Y");
+  for (int i = 0; big.size() < 20000; i++) big += "line " + std::to_string(i) + "\n";
+  std::ofstream(hostRoot + "/big.txt") << big;
+
+  CHECK(run(cli, "copy /big.txt /copy.txt", "ab\x03").find("^C") != std::string::npos, "copy cancel");
+  CHECK(!LittleFS.exists(TEMP_FILE), "copy cancel");
+  CHECK(!LittleFS.exists("/copy.txt"), "copy cancel");
+
+  CHECK(run(cli, "gzip /big.txt", "ab\x03").find("^C") != std::string::npos, "gzip cancel");
+  CHECK(!LittleFS.exists(TEMP_FILE), "gzip cancel");
+  CHECK(!LittleFS.exists("/big.txt.gz"), "gzip cancel");
+  CHECK(content("/big.txt") == big, "gzip cancel");
+
+  std::string out = run(cli, "type /big.txt -raw", "ab\x03");
+  CHECK(out.find("^C") != std::string::npos, "type cancel");
+  CHECK(out.size() < big.size(), "type cancel");
+
+  // Gzip output has no modes or slices
+  CHECK(run(cli, "type /big.txt -gz -o 10").find("-o wrong parameter!") != std::string::npos, "type -gz");
+  CHECK(run(cli, "type /big.txt hex -gz").find("hex wrong parameter!") != std::string::npos, "type -gz");
+
+  // Next command runs normally
+  run(cli, "copy /big.txt /copy.txt");
+  CHECK(content("/copy.txt") == big, "after cancel");
+  CHECK(Serial.available() == 0, "after cancel");
+}
+
+//-----------------------------------------------------
+int main(){
+//-----------------------------------------------------
+  hostRoot = hostfs::absolute("fsroot").string();
+  LittleFS.format();
+
+  LittleFS_CommandLineInterface cli;
+  testIndex(cli);
+  testDirSort(cli);
+  testType(cli);
+  testCancel(cli);
+
+  hostfs::remove_all(hostRoot);
+  printf(failures ? "%d check(s) failed\n" : "All tests passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+/*
+  test_gzip.cpp - Round trip tests of LittleFS_Gzip against zlib.
+  Released into the public domain.
+*/
+
+#include "LittleFS_Gzip.h"
+#include <zlib.h>
+#include <random>
+#include <vector>
+
+/*------------------------------------------------------------*/
+class MemoryStream : public Stream{
+/*------------------------------------------------------------*/
+  public:
+    std::string data;
+    size_t      pos   = 0;
+    size_t      chunk = 0;  // Max bytes of one read, 0 no limit
+
+    MemoryStream(const std::string &s = "") : data(s) {}
+    int    available() override { return data.size() - pos; }
+    int    read() override      { return pos < data.size() ? (uint8_t)data[pos++] : -1; }
+    int    peek() override      { return pos < data.size() ? (uint8_t)data[pos] : -1; }
+    size_t readBytes(char *buffer, size_t length) override{
+      length = min(length, data.size() - pos);
+      if (chunk > 0) length = min(length, chunk);
+      memcpy(buffer, data.data() + pos, length);
+      pos += length;
+      return length;
+    }
+    size_t write(uint8_t c) override { data.push_back(c); return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { data.append((const char*)buffer, size); return size; }
+    using Print::write;
+};
+
+static int failures = 0;
+
+#define CHECK(condition, name) \
+  if (!(condition)) { printf("FAILED: %s: %s\n", name, #condition); failures++; }
+
+//-----------------------------------------------------
+static std::string zlibCompress(const std::string &in, int windowBits, int level){
+//-----------------------------------------------------
+  z_stream    z = {};
+  std::string out(in.size() + in.size() / 100 + 1024, 0);
+
+  deflateInit2(&z, level, Z_DEFLATED, 16 + windowBits, 8, Z_DEFAULT_STRATEGY);
+  z.next_in   = (Bytef*)in.data();
+  z.avail_in  = in.size();
+  z.next_out  = (Bytef*)out.data();
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+//-----------------------------------------------------
+static bool zlibDecompress(const std::string &in, std::string &out){
+//-----------------------------------------------------
+  z_stream z = {};
+  int      result;
+  char     buffer[4096];
+
+  inflateInit2(&z, 16 + MAX_WBITS);
+  z.next_in  = (Bytef*)in.data();
+  z.avail_in = in.size();
+  do{
+    z.next_out  = (Bytef*)buffer;
+    z.avail_out = sizeof(buffer);
+    result = inflate(&z, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - z.avail_out);
+  }while (result == Z_OK);
+  inflateEnd(&z);
+  return result == Z_STREAM_END && z.avail_in == 0;
+}
+
+//-----------------------------------------------------
+static void roundTrip(const char *name, const std::string &data){
+//-----------------------------------------------------
+  LittleFS_Gzip gzip;
+  MemoryStream  in(data), compressed, out;
+  std::string   inflated;
+
+  CHECK(gzip.compress(in, compressed), name);
+  CHECK(zlibDecompress(compressed.data, inflated), name);
+  CHECK(inflated == data, name);
+
+  MemoryStream again(compressed.data);
+  CHECK(gzip.decompress(again, out), name);
+  CHECK(out.data == data, name);
+
+  // Same input compressed by zlib with a window that fits
+  for (int level : {0, 1, 9}){
+    MemoryStream zlib(zlibCompress(data, 12, level)), zlibOut;
+    CHECK(gzip.decompress(zlib, zlibOut), name);
+    CHECK(zlibOut.data == data, name);
+  }
+
+  // A changed byte is caught by the crc or the code checks
+  if (compressed.data.size() > 30){
+    MemoryStream broken(compressed.data), brokenOut;
+    broken.data[broken.data.size() / 2] ^= 0x55;
+    CHECK(!gzip.decompress(broken, brokenOut) || brokenOut.data != data, name);
+  }
+  printf("%-12s %8zu -> %8zu\n", name, data.size(), compressed.data.size());
+}
+
+//-----------------------------------------------------
+int main(){
+//-----------------------------------------------------
+  std::mt19937 random(1);
+  std::string  csv, noise(70000, 0), mixed;
+
+  for (int i = 0; i < 20000; i++){
+    csv += std::to_string(1700000000 + i * 60) + ";" + std::to_string(20 + random() % 10) + "." + std::to_string(random() % 10) + ";OK\n";
+  }
+  for (char &c : noise) c = random();
+  for (int i = 0; i < 3000; i++){
+    mixed += random() % 3 ? std::string(random() % 300, 'a' + random() % 3) : noise.substr(random() % 1000, random() % 50);
+  }
+
+  roundTrip("empty",  "");
+  roundTrip("one",    "a");
+  roundTrip("repeat", std::string(100000, 'x'));
+  roundTrip("csv",    csv);
+  roundTrip("noise",  noise);
+  roundTrip("mixed",  mixed);
+
+  // Sizes around the buffer and block edges, read in short pieces
+  for (size_t size : {1023, 1024, 1025, 2047, 2048, 2049, 2306, 4096, 4097, 9000}){
+    for (int text = 0; text < 2; text++){
+      LittleFS_Gzip gzip;
+      MemoryStream  in(text ? csv.substr(0, size) : noise.substr(0, size)), compressed, out;
+      std::string   inflated;
+      in.chunk = 7;
+      CHECK(gzip.compress(in, compressed), "edge");
+      CHECK(zlibDecompress(compressed.data, inflated) && inflated == in.data, "edge");
+      compressed.chunk = 5;
+      CHECK(gzip.decompress(compressed, out) && out.data == in.data, "edge");
+    }
+  }
+
+  // Incompressible data goes into stored blocks, 5 bytes per block of about 512 bytes
+  {
+    LittleFS_Gzip gzip;
+    MemoryStream  in(noise), out;
+    gzip.compress(in, out);
+    CHECK(out.data.size() < noise.size() + noise.size() / 50, "noise stored");
+  }
+
+  // Fixed codes alone gave 122 KB for the csv
+  {
+    LittleFS_Gzip gzip;
+    MemoryStream  in(csv), out;
+    gzip.compress(in, out);
+    CHECK(out.data.size() < csv.size() / 4, "csv dynamic");
+  }
+
+  // Cancel stops the compression before reading any input
+  {
+    LittleFS_Gzip gzip;
+    MemoryStream  in(csv), out;
+    gzip.onCancel([](){ return true; });
+    CHECK(!gzip.compress(in, out), "cancel");
+    CHECK(in.pos == 0, "cancel");
+  }
+
+  printf(failures ? "%d check(s) failed\n" : "All tests passed\n", failures);
+  return failures ? 1 : 0;
+}